@@ -1 +1 @@
-g++ -o main.exe main.cpp shape_container.cpp shape_quadtree.cpp shape.cpp lib/util.cpp lib/bound.cpp -luser32 -lgdi32 -lopengl32 -lgdiplus -lShlwapi -ldwmapi -lstdc++fs -static -std=c++17
+g++ -o main.exe main.cpp shape_container.cpp shape.cpp -luser32 -lgdi32 -lopengl32 -lgdiplus -lShlwapi -ldwmapi -lstdc++fs -static -std=c++17
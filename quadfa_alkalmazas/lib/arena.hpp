@@ -0,0 +1,99 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>           // std::vector
+#include <cstddef>          // std::size_t
+
+namespace qt {
+    /**
+     * @brief A region based allocator, which carves objects out of a few big chunks of memory
+     *      instead of allocating them one by one on the heap.
+     * @tparam T The type of the allocated objects.
+     * @note Objects can't be freed individually, they are all released together, either by clear()
+     *      or by the destructor of the Arena. Objects allocated together are contiguous in memory.
+     */
+    template <typename T>
+    class Arena {
+        public:
+            /**
+             * @brief Constructs an empty Arena.
+             * @param[in] firstChunkCapacity The number of objects that fit in the first chunk. The capacity
+             *      of the following chunks doubles, up to MAXCHUNKCAPACITY.
+             */
+            Arena(std::size_t firstChunkCapacity = 64);
+
+            /**
+             * @brief No copy constructor, the Arena owns the memory of its objects.
+             */
+            Arena(const Arena<T> &other) = delete;
+
+            /**
+             * @brief No move constructor, the objects may point into each other.
+             */
+            Arena(Arena<T> &&other) = delete;
+
+            /**
+             * @brief Destroys all the objects, and releases all the chunks.
+             */
+            ~Arena();
+
+            /**
+             * @brief Reserves contiguous storage for the given number of objects.
+             * @param[in] count The number of objects, at most MAXCHUNKCAPACITY.
+             * @return A pointer to the uninitialized storage of the first object.
+             * @note All the objects have to be constructed (with placement new) by the caller right away,
+             *      because the Arena destroys them upon release.
+             */
+            T* allocate(std::size_t count);
+
+            /**
+             * @brief Destroys all the objects, but keeps the chunks for the following allocations.
+             */
+            void clear();
+
+            /**
+             * @brief Returns the number of objects living in the Arena.
+             */
+            std::size_t size() const;
+
+        protected:
+            /**
+             * @brief The upper limit of the number of objects in one chunk.
+             */
+            static const std::size_t MAXCHUNKCAPACITY = 16384;
+
+            /**
+             * @brief A block of memory, from which the objects are carved in order.
+             */
+            struct Chunk {
+                T* storage;
+                std::size_t capacity;
+                std::size_t used;
+            };
+
+            /**
+             * @brief Destroys the objects of the chunks, and marks the chunks empty.
+             */
+            void destroyAll();
+
+            /**
+             * @brief The chunks, in the order they were allocated.
+             */
+            std::vector<Chunk> chunks;
+
+            /**
+             * @brief The index of the chunk from which the next objects are carved.
+             */
+            std::size_t currentChunk;
+
+            /**
+             * @brief The capacity of the next chunk that needs to be allocated.
+             */
+            std::size_t nextChunkCapacity;
+    };
+}
+
+// The template definitions, so that the class can be used header-only, without explicit instantiation
+#include "arena.tpp"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "arena.hpp"        // class declarations
+
+#include <new>              // operator new, operator delete
+#include <type_traits>      // std::is_trivially_destructible
+
+namespace qt {
+    /*------------------------------------------------
+            Arena template class implementation
+    --------------------------------------------------*/
+
+    // Constructs an empty Arena.
+    template <typename T>
+    Arena<T>::Arena(std::size_t firstChunkCapacity) : currentChunk(0), nextChunkCapacity(firstChunkCapacity) {}
+
+    // Destroys all the objects, and releases all the chunks.
+    template <typename T>
+    Arena<T>::~Arena() {
+        destroyAll();
+        for(auto &chunk : chunks) {
+            ::operator delete(chunk.storage);
+        }
+    }
+
+    // Reserves contiguous storage for the given number of objects.
+    template <typename T>
+    T* Arena<T>::allocate(std::size_t count) {
+        // Skip the chunks that don't have enough room left (the end of them remains unused)
+        while(currentChunk < chunks.size() && chunks[currentChunk].used + count > chunks[currentChunk].capacity) {
+            currentChunk++;
+        }
+
+        // If we ran out of chunks, allocate a new, bigger one
+        if(currentChunk == chunks.size()) {
+            while(nextChunkCapacity < count) {
+                nextChunkCapacity *= 2;
+            }
+            chunks.push_back(Chunk{static_cast<T*>(::operator new(nextChunkCapacity * sizeof(T))), nextChunkCapacity, 0});
+            if(nextChunkCapacity < MAXCHUNKCAPACITY) {
+                nextChunkCapacity *= 2;
+            }
+        }
+
+        Chunk &chunk = chunks[currentChunk];
+        T* objects = chunk.storage + chunk.used;
+        chunk.used += count;
+        return objects;
+    }
+
+    // Destroys all the objects, but keeps the chunks for the following allocations.
+    template <typename T>
+    void Arena<T>::clear() {
+        destroyAll();
+        currentChunk = 0;
+    }
+
+    // Returns the number of objects living in the Arena.
+    template <typename T>
+    std::size_t Arena<T>::size() const {
+        std::size_t count = 0;
+        for(const auto &chunk : chunks) {
+            count += chunk.used;
+        }
+        return count;
+    }
+
+    // Destroys the objects of the chunks, and marks the chunks empty.
+    template <typename T>
+    void Arena<T>::destroyAll() {
+        for(auto &chunk : chunks) {
+            // Trivially destructible objects are released without touching them
+            if(!std::is_trivially_destructible<T>::value) {
+                for(std::size_t i = 0; i < chunk.used; i++) {
+                    chunk.storage[i].~T();
+                }
+            }
+            chunk.used = 0;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,575 @@
+#include "linear_quadtree.hpp"      // class declarations
+
+#include <utility>                  // std::move, std::forward, std::make_pair
+#include <algorithm>                // std::lower_bound, std::stable_sort, std::inplace_merge
+#include <numeric>                  // std::iota
+#include <type_traits>              // std::is_void
+
+namespace qt {
+    /*------------------------------------------------
+        LinearQuadTree template class implementation
+    --------------------------------------------------*/
+
+    // Constructs an empty LinearQuadTree in the given bound.
+    template <typename T>
+    LinearQuadTree<T>::LinearQuadTree(const Bound &bound) : bound(bound) {
+        clear();
+    }
+
+    // Inserts an element into the LinearQuadTree.
+    template <typename T>
+    typename LinearQuadTree<T>::Handle LinearQuadTree<T>::insert(const T &itemWithBound) {
+        return emplace(itemWithBound);
+    }
+
+    // Inserts an element into the LinearQuadTree, by moving it.
+    template <typename T>
+    typename LinearQuadTree<T>::Handle LinearQuadTree<T>::insert(T &&itemWithBound) {
+        return emplace(std::move(itemWithBound));
+    }
+
+    // Inserts an element into the LinearQuadTree, constructed in place from the given arguments.
+    template <typename T>
+    template <typename... Args>
+    typename LinearQuadTree<T>::Handle LinearQuadTree<T>::emplace(Args&&... args) {
+        Handle handle = items.emplace(std::forward<Args>(args)...);
+        const Bound itemBound = items[handle];
+
+        // Descend from the root, as long as one of the quadrons contains the item
+        uint32_t code = 1;
+        Bound currentBound = bound;
+        int depth = 0;
+        while(!isLeaf(currentBound, depth)) {
+            std::array<Bound, 4> division = currentBound.getQuadDivision();
+
+            int i = 0;
+            while(i < 4 && !division[i].contains(itemBound)) {
+                i++;
+            }
+            if(i == 4) {
+                break;
+            }
+
+            // Create the child first, because it may grow the table, and only then mark it in the parent
+            uint32_t childCode = (code << 2) | i;
+            findOrCreateNode(childCode);
+            getNode(code).childMask |= 1 << i;
+
+            code = childCode;
+            currentBound = division[i];
+            depth++;
+        }
+
+        // Append the item to its level. If it belongs after all the sorted items, it is already in its sorted place.
+        Level &level = levels[depth];
+        if(level.packedCount == level.items.size() && (level.codes.empty() || level.codes.back() <= code)) {
+            Node &node = getNode(code);
+            if(node.count == 0) {
+                node.begin = static_cast<uint32_t>(level.items.size());
+            }
+            node.count++;
+            level.packedCount++;
+        }
+        level.items.push_back(handle, itemBound);
+        level.codes.push_back(code);
+        return handle;
+    }
+
+    // Searches the LinearQuadTree for elements that overlap with the given bound.
+    template <typename T>
+    std::vector<typename LinearQuadTree<T>::Handle> LinearQuadTree<T>::queryOverlap(const Bound &bound) const {
+        std::vector<Handle> foundItems;
+        queryOverlap(bound, foundItems);
+        return foundItems;
+    }
+
+    // Searches the LinearQuadTree for elements that overlap with the given bound, appending them to the given container.
+    template <typename T>
+    void LinearQuadTree<T>::queryOverlap(const Bound &bound, std::vector<Handle> &foundItems) const {
+        auto rangeFn = [&foundItems](const Handle *first, const Handle *last) {foundItems.insert(foundItems.end(), first, last); return true;};
+        visit(bound, [](const Bound &a, const Bound &b) {return a.overlaps(b);}, rangeFn);
+    }
+
+    // Searches the LinearQuadTree for elements that are fully contained within the given bound.
+    template <typename T>
+    std::vector<typename LinearQuadTree<T>::Handle> LinearQuadTree<T>::queryContain(const Bound &bound) const {
+        std::vector<Handle> foundItems;
+        queryContain(bound, foundItems);
+        return foundItems;
+    }
+
+    // Searches the LinearQuadTree for elements that are fully contained within the given bound, appending them to the given container.
+    template <typename T>
+    void LinearQuadTree<T>::queryContain(const Bound &bound, std::vector<Handle> &foundItems) const {
+        auto rangeFn = [&foundItems](const Handle *first, const Handle *last) {foundItems.insert(foundItems.end(), first, last); return true;};
+        visit(bound, [](const Bound &a, const Bound &b) {return a.contains(b);}, rangeFn);
+    }
+
+    // Passes the elements that overlap with the given bound to the callback, one by one.
+    template <typename T>
+    template <typename Callback>
+    bool LinearQuadTree<T>::forEachOverlap(const Bound &bound, Callback callback) const {
+        auto rangeFn = [&callback](const Handle *first, const Handle *last) {return invokeForEach(callback, first, last);};
+        return visit(bound, [](const Bound &a, const Bound &b) {return a.overlaps(b);}, rangeFn);
+    }
+
+    // Passes the elements that are fully contained within the given bound to the callback, one by one.
+    template <typename T>
+    template <typename Callback>
+    bool LinearQuadTree<T>::forEachContain(const Bound &bound, Callback callback) const {
+        auto rangeFn = [&callback](const Handle *first, const Handle *last) {return invokeForEach(callback, first, last);};
+        return visit(bound, [](const Bound &a, const Bound &b) {return a.contains(b);}, rangeFn);
+    }
+
+    // Passes the elements that overlap with the given bound to the callback, in contiguous ranges.
+    template <typename T>
+    template <typename Callback>
+    bool LinearQuadTree<T>::forEachOverlapRange(const Bound &bound, Callback callback) const {
+        auto rangeFn = [&callback](const Handle *first, const Handle *last) {return invokeCallback(callback, first, last);};
+        return visit(bound, [](const Bound &a, const Bound &b) {return a.overlaps(b);}, rangeFn);
+    }
+
+    // Passes the elements that are fully contained within the given bound to the callback, in contiguous ranges.
+    template <typename T>
+    template <typename Callback>
+    bool LinearQuadTree<T>::forEachContainRange(const Bound &bound, Callback callback) const {
+        auto rangeFn = [&callback](const Handle *first, const Handle *last) {return invokeCallback(callback, first, last);};
+        return visit(bound, [](const Bound &a, const Bound &b) {return a.contains(b);}, rangeFn);
+    }
+
+    // Removes all elements from the LinearQuadTree that overlap with the given bound.
+    template <typename T>
+    void LinearQuadTree<T>::removeOverlap(const Bound &bound) {
+        QueryScratch scratch;
+        removeOverlap(bound, scratch);
+    }
+
+    // Removes all elements from the LinearQuadTree that overlap with the given bound, using the given working memory.
+    template <typename T>
+    void LinearQuadTree<T>::removeOverlap(const Bound &bound, QueryScratch &scratch) {
+        remove(bound, [](const Bound &a, const Bound &b) {return a.overlaps(b);}, scratch);
+    }
+
+    // Removes all elements from the LinearQuadTree that are contained within the given bound.
+    template <typename T>
+    void LinearQuadTree<T>::removeContain(const Bound &bound) {
+        QueryScratch scratch;
+        removeContain(bound, scratch);
+    }
+
+    // Removes all elements from the LinearQuadTree that are contained within the given bound, using the given working memory.
+    template <typename T>
+    void LinearQuadTree<T>::removeContain(const Bound &bound, QueryScratch &scratch) {
+        remove(bound, [](const Bound &a, const Bound &b) {return a.contains(b);}, scratch);
+    }
+
+    // Sorts the recently inserted elements into the arrays of their levels.
+    template <typename T>
+    void LinearQuadTree<T>::pack() {
+        for(Level &level : levels) {
+            const std::size_t itemCount = level.items.size();
+            if(level.packedCount == itemCount) {
+                continue;
+            }
+
+            // Sort the new items by their codes, and merge them with the sorted ones (within a node, the order of insertion is kept)
+            std::vector<uint32_t> order(itemCount);
+            std::iota(order.begin(), order.end(), 0);
+            auto byCode = [&level](uint32_t a, uint32_t b) {return level.codes[a] < level.codes[b];};
+            std::stable_sort(order.begin() + level.packedCount, order.end(), byCode);
+            std::inplace_merge(order.begin(), order.begin() + level.packedCount, order.end(), byCode);
+
+            // Lay out the items in the merged order, and set the ranges of their nodes on the way
+            ItemBucket<Handle> sortedItems;
+            std::vector<uint32_t> sortedCodes;
+            sortedItems.reserve(itemCount);
+            sortedCodes.reserve(itemCount);
+            Node *node = nullptr;
+            for(uint32_t index : order) {
+                if(sortedCodes.empty() || sortedCodes.back() != level.codes[index]) {
+                    node = &getNode(level.codes[index]);
+                    node->begin = static_cast<uint32_t>(sortedCodes.size());
+                    node->count = 0;
+                }
+                node->count++;
+
+                sortedItems.push_back(level.items.handles[index], level.items.getBound(index));
+                sortedCodes.push_back(level.codes[index]);
+            }
+
+            level.items = std::move(sortedItems);
+            level.codes = std::move(sortedCodes);
+            level.packedCount = itemCount;
+        }
+    }
+
+    // Decides whether all the elements are in their sorted place, i.e. there was no insertion since the last pack().
+    template <typename T>
+    bool LinearQuadTree<T>::isPacked() const {
+        for(const Level &level : levels) {
+            if(level.packedCount != level.items.size()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns all the boundaries that make up the LinearQuadTree.
+    template <typename T>
+    std::vector<Bound> LinearQuadTree<T>::getBounds() const {
+        std::vector<Bound> bounds;
+
+        // Visit all the nodes in a DFS style, deriving the bounds of the children from the bound of the parent
+        std::vector<NodeVisit> nodeStack;
+        nodeStack.push_back(NodeVisit{1, bound});
+        while(!nodeStack.empty()) {
+            NodeVisit current = nodeStack.back();
+            nodeStack.pop_back();
+            bounds.push_back(current.bound);
+
+            uint8_t childMask = getNode(current.code).childMask;
+            if(childMask) {
+                std::array<Bound, 4> division = current.bound.getQuadDivision();
+                for(int i = 0; i < 4; i++) {
+                    if(childMask & (1 << i)) {
+                        nodeStack.push_back(NodeVisit{(current.code << 2) | i, division[i]});
+                    }
+                }
+            }
+        }
+
+        return bounds;
+    }
+
+    // Removes all the elements and nodes from the LinearQuadTree.
+    template <typename T>
+    void LinearQuadTree<T>::clear() {
+        items.clear();
+        for(Level &level : levels) {
+            level.items.clear();
+            level.codes.clear();
+            level.packedCount = 0;
+        }
+        nodes.assign(16, Node{NOCODE, 0, 0, 0});
+        nodeCount = 0;
+
+        // Only the root exists in an empty tree
+        findOrCreateNode(1);
+    }
+
+    // Accesses the element identified by the given Handle.
+    template <typename T>
+    T& LinearQuadTree<T>::operator[](const Handle &handle) {
+        return items[handle];
+    }
+
+    template <typename T>
+    const T& LinearQuadTree<T>::operator[](const Handle &handle) const {
+        return items[handle];
+    }
+
+    // Decides whether the given Handle still identifies an element of the LinearQuadTree.
+    template <typename T>
+    bool LinearQuadTree<T>::contains(const Handle &handle) const {
+        return items.contains(handle);
+    }
+
+    // Returns the number of elements stored in the LinearQuadTree.
+    template <typename T>
+    std::size_t LinearQuadTree<T>::size() const {
+        return items.size();
+    }
+
+    // Derives the bound of a node from its locational code.
+    template <typename T>
+    Bound LinearQuadTree<T>::getNodeBound(uint32_t code) const {
+        // Follow the path of the code from the root, two bits per level
+        Bound nodeBound = bound;
+        for(int level = getDepth(code) - 1; level >= 0; level--) {
+            nodeBound = nodeBound.getQuadDivision()[(code >> (2 * level)) & 3];
+        }
+        return nodeBound;
+    }
+
+    // Finds the entry of a node in the hash table.
+    template <typename T>
+    std::size_t LinearQuadTree<T>::findSlot(uint32_t code) const {
+        // Mix the bits of the code (the codes of the nodes on one level only differ in the low bits)
+        uint32_t hash = code;
+        hash ^= hash >> 16;
+        hash *= 0x85EBCA6B;
+        hash ^= hash >> 13;
+        hash *= 0xC2B2AE35;
+        hash ^= hash >> 16;
+
+        // Linear probing, the table is never full
+        std::size_t mask = nodes.size() - 1;
+        std::size_t slot = hash & mask;
+        while(nodes[slot].code != NOCODE && nodes[slot].code != code) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    // Returns the node with the given code, creating it if it doesn't exist.
+    template <typename T>
+    typename LinearQuadTree<T>::Node& LinearQuadTree<T>::findOrCreateNode(uint32_t code) {
+        std::size_t slot = findSlot(code);
+        if(nodes[slot].code == NOCODE) {
+            // Keep the load factor at most 1/2, so that the probe sequences remain short
+            if(2 * (nodeCount + 1) > nodes.size()) {
+                grow();
+                slot = findSlot(code);
+            }
+
+            nodes[slot] = Node{code, 0, 0, 0};
+            nodeCount++;
+        }
+        return nodes[slot];
+    }
+
+    // Returns the existing node with the given code.
+    template <typename T>
+    const typename LinearQuadTree<T>::Node& LinearQuadTree<T>::getNode(uint32_t code) const {
+        return nodes[findSlot(code)];
+    }
+
+    template <typename T>
+    typename LinearQuadTree<T>::Node& LinearQuadTree<T>::getNode(uint32_t code) {
+        return nodes[findSlot(code)];
+    }
+
+    // Doubles the capacity of the hash table, and reinserts all the nodes.
+    template <typename T>
+    void LinearQuadTree<T>::grow() {
+        std::vector<Node> oldNodes(nodes.size() * 2, Node{NOCODE, 0, 0, 0});
+        oldNodes.swap(nodes);
+        for(const auto &node : oldNodes) {
+            if(node.code != NOCODE) {
+                nodes[findSlot(node.code)] = node;
+            }
+        }
+    }
+
+    // Decides whether a node at the given depth, with the given bound, can't have children.
+    template <typename T>
+    bool LinearQuadTree<T>::isLeaf(const Bound &bound, int depth) {
+        return !(bound.quadDivisible()) || depth + 1 == MAXDEPTH;
+    }
+
+    // Returns the depth of a node, based on its code.
+    template <typename T>
+    int LinearQuadTree<T>::getDepth(uint32_t code) {
+        // Every level adds two bits after the leading 1 bit of the root
+        int depth = 0;
+        while(code > 1) {
+            code >>= 2;
+            depth++;
+        }
+        return depth;
+    }
+
+    // Returns the range of the items of a subtree in the sorted part of a level.
+    template <typename T>
+    std::pair<std::size_t, std::size_t> LinearQuadTree<T>::getSubtreeRange(uint32_t code, int level) const {
+        // The codes of the descendants on the level share the code of the subtree root as their prefix
+        const int shift = 2 * (level - getDepth(code));
+        const std::vector<uint32_t> &codes = levels[level].codes;
+        auto first = codes.begin(), last = codes.begin() + levels[level].packedCount;
+        return std::make_pair(
+            std::size_t(std::lower_bound(first, last, code << shift) - first),
+            std::size_t(std::lower_bound(first, last, (code + 1) << shift) - first)
+        );
+    }
+
+    // Visits the elements that are in relation with the given bound, based on the binary predicate.
+    template <typename T>
+    template <typename Predicate, typename RangeCallback>
+    bool LinearQuadTree<T>::visit(const Bound &bound, Predicate predicateFn, RangeCallback &rangeCallback) const {
+        // The nodes that are still to be inspected, in a DFS order
+        std::array<NodeVisit, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+
+        nodeStack[stackSize++] = NodeVisit{1, this->bound};
+        while(stackSize > 0) {
+            NodeVisit current = nodeStack[--stackSize];
+            const int depth = getDepth(current.code);
+
+            // If the node is fully contained within the query, its subtree is a single range on each level.
+            // Not the root though: the elements outside of the tree bound are kept in it.
+            if(current.code != 1 && bound.contains(current.bound)) {
+                for(int level = depth; level < MAXDEPTH; level++) {
+                    std::pair<std::size_t, std::size_t> range = getSubtreeRange(current.code, level);
+                    const Handle *handles = levels[level].items.handles.data();
+                    if(range.first != range.second && !rangeCallback(handles + range.first, handles + range.second)) {
+                        return false;
+                    }
+                }
+                continue;
+            }
+
+            // Otherwise check its items one by one, using only the bounds stored in the level
+            const Node &node = getNode(current.code);
+            const ItemBucket<Handle> &levelItems = levels[depth].items;
+            for(std::size_t i = node.begin; i < node.begin + node.count; i++) {
+                if(predicateFn(bound, levelItems.getBound(i)) && !rangeCallback(&levelItems.handles[i], &levelItems.handles[i] + 1)) {
+                    return false;
+                }
+            }
+
+            // And visit the existing children that overlap with the query (in reverse order, so that NW is visited first)
+            if(node.childMask) {
+                std::array<Bound, 4> division = current.bound.getQuadDivision();
+                for(int i = 3; i >= 0; i--) {
+                    if((node.childMask & (1 << i)) && bound.overlaps(division[i])) {
+                        nodeStack[stackSize++] = NodeVisit{(current.code << 2) | i, division[i]};
+                    }
+                }
+            }
+        }
+
+        // The items inserted since the last pack() are tested one by one
+        for(const Level &level : levels) {
+            for(std::size_t i = level.packedCount; i < level.items.size(); i++) {
+                if(predicateFn(bound, level.items.getBound(i)) && !rangeCallback(&level.items.handles[i], &level.items.handles[i] + 1)) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Removes the elements that are in relation with the given bound, based on the binary predicate.
+    template <typename T>
+    template <typename Predicate>
+    void LinearQuadTree<T>::remove(const Bound &bound, Predicate predicateFn, QueryScratch &scratch) {
+        // The items are erased from the SlotMap first, and the levels that have lost any are compacted at the end
+        std::array<bool, MAXDEPTH> changedLevels{};
+
+        // The nodes that are to be inspected (reusing the memory of the scratch)
+        std::vector<NodeVisit> &nodeRemoveStack = scratch.nodeStack;
+        nodeRemoveStack.clear();
+
+        nodeRemoveStack.push_back(NodeVisit{1, this->bound});
+        while(!nodeRemoveStack.empty()) {
+            NodeVisit current = nodeRemoveStack.back();
+            nodeRemoveStack.pop_back();
+            const int depth = getDepth(current.code);
+
+            // Remove all the items of a fully contained subtree (other than the whole tree), range by range
+            if(current.code != 1 && bound.contains(current.bound)) {
+                for(int level = depth; level < MAXDEPTH; level++) {
+                    std::pair<std::size_t, std::size_t> range = getSubtreeRange(current.code, level);
+                    for(std::size_t i = range.first; i < range.second; i++) {
+                        items.erase(levels[level].items.handles[i]);
+                    }
+                    changedLevels[level] = changedLevels[level] || range.first != range.second;
+                }
+                continue;
+            }
+
+            const Node &node = getNode(current.code);
+            const ItemBucket<Handle> &levelItems = levels[depth].items;
+            for(std::size_t i = node.begin; i < node.begin + node.count; i++) {
+                if(predicateFn(bound, levelItems.getBound(i))) {
+                    items.erase(levelItems.handles[i]);
+                    changedLevels[depth] = true;
+                }
+            }
+
+            if(node.childMask) {
+                std::array<Bound, 4> division = current.bound.getQuadDivision();
+                for(int i = 0; i < 4; i++) {
+                    if((node.childMask & (1 << i)) && bound.overlaps(division[i])) {
+                        nodeRemoveStack.push_back(NodeVisit{(current.code << 2) | i, division[i]});
+                    }
+                }
+            }
+        }
+
+        // The items inserted since the last pack(), the same way as in visit
+        for(int depth = 0; depth < MAXDEPTH; depth++) {
+            const Level &level = levels[depth];
+            for(std::size_t i = level.packedCount; i < level.items.size(); i++) {
+                if(predicateFn(bound, level.items.getBound(i))) {
+                    items.erase(level.items.handles[i]);
+                    changedLevels[depth] = true;
+                }
+            }
+        }
+
+        for(int depth = 0; depth < MAXDEPTH; depth++) {
+            if(changedLevels[depth]) {
+                compact(depth);
+            }
+        }
+    }
+
+    // Drops the removed items from the array of a level, and updates the ranges of its nodes.
+    template <typename T>
+    void LinearQuadTree<T>::compact(int depth) {
+        Level &level = levels[depth];
+        ItemBucket<Handle> &levelItems = level.items;
+
+        // Move the remaining items forward, keeping their order
+        std::size_t keptCount = 0;
+        auto keep = [&](std::size_t i) {
+            if(!items.contains(levelItems.handles[i])) {
+                return false;
+            }
+            levelItems.handles[keptCount] = levelItems.handles[i];
+            levelItems.setBound(keptCount, levelItems.getBound(i));
+            level.codes[keptCount] = level.codes[i];
+            keptCount++;
+            return true;
+        };
+
+        // The sorted items of a node are consecutive, so its new range starts where its first item is moved
+        Node *node = nullptr;
+        for(std::size_t i = 0; i < level.packedCount; i++) {
+            if(i == 0 || level.codes[i] != level.codes[i - 1]) {
+                node = &getNode(level.codes[i]);
+                node->begin = static_cast<uint32_t>(keptCount);
+                node->count = 0;
+            }
+            if(keep(i)) {
+                node->count++;
+            }
+        }
+        const std::size_t packedCount = keptCount;
+
+        for(std::size_t i = level.packedCount; i < levelItems.size(); i++) {
+            keep(i);
+        }
+
+        levelItems.truncate(keptCount);
+        level.codes.resize(keptCount);
+        level.packedCount = packedCount;
+    }
+
+    // Calls the visitor callback with the given arguments, and tells whether the traversal should continue.
+    template <typename T>
+    template <typename Callback, typename... Args>
+    bool LinearQuadTree<T>::invokeCallback(Callback &callback, const Args&... args) {
+        // A callback returning nothing never stops the traversal
+        if constexpr (std::is_void<decltype(callback(args...))>::value) {
+            callback(args...);
+            return true;
+        } else {
+            return callback(args...);
+        }
+    }
+
+    // Calls the visitor callback with each element of a range, and tells whether the traversal should continue.
+    template <typename T>
+    template <typename Callback>
+    bool LinearQuadTree<T>::invokeForEach(Callback &callback, const Handle *first, const Handle *last) {
+        for(; first != last; ++first) {
+            if(!invokeCallback(callback, *first)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
\ No newline at end of file
@@ -3,11 +3,15 @@
 
 #include "bound.hpp"        /// qt::Bound
 #include "util.hpp"         /// qt::Vec2D_i32
+#include "slotmap.hpp"      /// qt::SlotMap
+#include "arena.hpp"        /// qt::Arena
+#include "item_bucket.hpp"  /// qt::ItemBucket
+#include "region.hpp"       /// qt::RegionRelation, qt::ConvexPolygon
 
-#include <list>             /// std::list
 #include <vector>           /// std::vector
 #include <type_traits>      /// std::is_convertible
-#include <functional>
+#include <limits>           /// std::numeric_limits
+#include <utility>          /// std::pair
 
 /**
  * @brief Wrapper namespace for the QuadTree and related classes.
@@ -32,8 +36,40 @@ namespace qt {
             /**
              * @brief The type of the elements stored in each QuadTreeNode,
              *      and also the type of the container that is the result of a query.
+             * @note A Handle stays valid until its own element is removed from the QuadTree,
+             *      and it can be resolved with QuadTree<T>::operator[].
              */
-            typedef typename std::list<T>::iterator l_Iter;
+            typedef typename SlotMap<T>::Handle Handle;
+
+            /**
+             * @brief Reusable working memory of the removals (the traversal stacks) and of the batched queries, so that
+             *      once it has grown large enough, repeated removals/batches don't allocate.
+             * @note It can be passed to any number of calls, but only to one call at a time. The single queries need no
+             *      scratch, their traversal uses a fixed size stack.
+             */
+            struct QueryScratch;
+
+            /**
+             * @brief Insertions, updates and removals, collected to be applied together by QuadTree<T>::apply (e.g. once per frame).
+             * @note The QuadTree is not modified until the Batch is applied, so the queries in the meantime see its previous state.
+             */
+            struct Batch;
+
+            /**
+             * @brief The results of a batch of queries in compressed (CSR) form: the Handles found by the i-th query
+             *      are items[offsets[i]], ..., items[offsets[i + 1] - 1].
+             */
+            struct BatchResult {
+                /**
+                 * @brief The start of the results of each query in items, and the total number of results at the end.
+                 */
+                std::vector<std::size_t> offsets;
+
+                /**
+                 * @brief The Handles found by all the queries, grouped by the queries, in the order of the queries.
+                 */
+                std::vector<Handle> items;
+            };
 
             /**     
              * @brief Constructs an empty QuadTree in the given bound.
@@ -42,6 +78,17 @@ namespace qt {
              */
             QuadTree(const Bound &bound);
 
+            /**
+             * @brief Constructs a QuadTree in the given bound, and loads the elements of the range at once.
+             * @tparam InputIt An input iterator type, whose value type is T.
+             * @param[in] bound The bound that contains all the future elements of the QuadTree.
+             * @param[in] first The beginning of the range of the elements.
+             * @param[in] last The end of the range of the elements.
+             * @see QuadTree<T>::build
+             */
+            template <typename InputIt>
+            QuadTree(const Bound &bound, InputIt first, InputIt last);
+
             /**
              * @brief No copy constructor (yet).
              * @todo Implement copy constructor.
@@ -56,31 +103,452 @@ namespace qt {
 
             /**
              * @brief Destructs the QuadTree.
+             * @note All the nodes are released together with the arena that they were allocated from.
              */
             virtual ~QuadTree();     
 
+            /**
+             * @brief Removes all the elements from the QuadTree, and releases its inner structure at once.
+             * @note The memory of the arena is kept for the future nodes. All the Handles become invalid.
+             */
+            virtual void clear();
+
+            /**
+             * @brief Removes all the elements from the QuadTree, and loads the elements of the range at once (bulk loading).
+             * @tparam InputIt An input iterator type, whose value type is T.
+             * @param[in] first The beginning of the range of the elements.
+             * @param[in] last The end of the range of the elements.
+             * @note The result is the same tree as with inserting the elements one by one, but instead of walking the nodes
+             *      from the root for each element, the target node of every element is encoded in a locational code (from
+             *      the coordinates only), and the elements are sorted by these codes with a counting sort. The nodes are
+             *      created in pre-order (so the nodes of a subtree are close to each other in the arena), and the items
+             *      of every node are allocated at once, with their exact size. The elements that are not inside of the bound
+             *      of the QuadTree are kept in the root, the same way as by insert.
+             */
+            template <typename InputIt>
+            void build(InputIt first, InputIt last);
+
+            /**
+             * @brief Removes all the elements from the QuadTree, and loads the elements of the range at once (bulk loading).
+             * @param[in] first The beginning of the range of the elements.
+             * @param[in] last The end of the range of the elements.
+             * @param[out] handles The Handles of the loaded elements are appended to it, in the order of the range.
+             * @note The elements are moved instead of copied, if the range is given by std::move_iterators.
+             * @see QuadTree<T>::build(InputIt, InputIt)
+             */
+            template <typename InputIt>
+            void build(InputIt first, InputIt last, std::vector<Handle> &handles);
+
             /**
              * @brief Inserts an element into the QuadTree.
              * @param[in] itemWithBound An element with type T, which needs to be inserted into the QuadTree.
+             * @return The Handle of the inserted element.
              * @note The element will be inserted iff. the bound of the QuadTree fully contains it.
              */                    
-            virtual void insert(const T &itemWithBound);
+            virtual Handle insert(const T &itemWithBound);
+
+            /**
+             * @brief Inserts an element into the QuadTree, by moving it into the main container.
+             * @param[in] itemWithBound An element with type T, which needs to be inserted into the QuadTree.
+             * @return The Handle of the inserted element.
+             * @note The element will be inserted iff. the bound of the QuadTree fully contains it.
+             */
+            virtual Handle insert(T &&itemWithBound);
+
+            /**
+             * @brief Inserts an element into the QuadTree, constructed in place in the main container.
+             * @param[in] args The arguments forwarded to the constructor of T.
+             * @return The Handle of the inserted element.
+             * @note The element is never copied, its bound is read after it has been constructed.
+             */
+            template <typename... Args>
+            Handle emplace(Args&&... args);
+
+            /**
+             * @brief Inserts the elements of the range into the QuadTree one by one, keeping the existing elements.
+             * @tparam InputIt An input iterator type, whose value type is T.
+             * @param[in] first The beginning of the range of the elements.
+             * @param[in] last The end of the range of the elements.
+             * @param[out] handles The Handles of the inserted elements are appended to it, in the order of the range.
+             * @note The elements are moved instead of copied, if the range is given by std::move_iterators.
+             */
+            template <typename InputIt>
+            void insert(InputIt first, InputIt last, std::vector<Handle> &handles);
+
+            /**
+             * @brief Replaces an element of the QuadTree, and relocates it in the tree structure according to its new bound.
+             * @param[in] handle The Handle of the element, it stays valid.
+             * @param[in] itemWithBound The new value of the element.
+             * @return true if the element was updated, false if the Handle is invalid (its element has been removed).
+             * @note If the new bound still belongs to the same node, only the stored bound is overwritten. Otherwise the
+             *      element climbs to the lowest ancestor that contains the new bound (using the parent pointers), and
+             *      descends from there, instead of being removed and inserted from the root.
+             */
+            bool update(const Handle &handle, const T &itemWithBound);
+
+            /**
+             * @brief Relocates an element in the tree structure, after its bound has been modified through operator[].
+             * @param[in] handle The Handle of the element, it stays valid.
+             * @return true if the element was updated, false if the Handle is invalid (its element has been removed).
+             * @see QuadTree<T>::update(const Handle&, const T&)
+             */
+            bool update(const Handle &handle);
+
+            /**
+             * @brief Removes a single element from the QuadTree.
+             * @param[in] handle The Handle of the element that needs to be removed.
+             * @return true if the element was removed, false if the Handle is invalid (its element has been removed already).
+             * @note It takes constant time (apart from updating the item counts of the ancestors, at most MAXDEPTH nodes):
+             *      the node and the position of the element are known from its back-reference, and the last element
+             *      of the node is moved in its place.
+             */
+            bool erase(const Handle &handle);
+
+            /**
+             * @brief Applies all the mutations of a Batch at once.
+             * @param[in,out] batch The collected mutations, it is cleared afterwards (but its memory is kept).
+             * @note The removals are applied first, then the updates, and finally the insertions. The updates and removals
+             *      of invalid Handles are skipped, and if an element is updated several times, its last value is kept.
+             *      The updated elements that stay in their nodes only overwrite their stored bounds, while the inserted
+             *      elements and the ones that leave their nodes are loaded together, sorted by the locational codes of
+             *      their target nodes (see QuadTree<T>::build), so the nodes on their paths are visited once per batch,
+             *      instead of once per element.
+             */
+            void apply(Batch &batch);
+
+            /**
+             * @brief Applies all the mutations of a Batch at once, returning the Handles of the inserted elements.
+             * @param[in,out] batch The collected mutations, it is cleared afterwards (but its memory is kept).
+             * @param[out] insertedHandles The Handles of the inserted elements are appended to it, in the order of the insertions.
+             * @see QuadTree<T>::apply(Batch&)
+             */
+            void apply(Batch &batch, std::vector<Handle> &insertedHandles);
 
             /**
              * @brief Searches the QuadTree for elements that overlap with the given bound.
              * @param[in] bound The search bound that all the found elements should overlap with.
-             * @return A std::vector of l_Iter (std::list<T>::iterator) elements, which are valid iterators in the inner
-             *      container of the QuadTree, and which point to the found elements.
+             * @return A std::vector of Handles, which identify the found elements in the inner container of the QuadTree.
+             */
+            virtual std::vector<Handle> queryOverlap(const qt::Bound &bound) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with the given bound, into a caller-owned container.
+             * @param[in] bound The search bound that all the found elements should overlap with.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             * @note If the container is reused (cleared, but not released) between the queries, a query allocates
+             *      only when it finds more elements than ever before.
              */
-            virtual std::vector<l_Iter> queryOverlap(const qt::Bound &bound) const;
+            virtual void queryOverlap(const qt::Bound &bound, std::vector<Handle> &foundItems) const;
 
             /**
              * @brief Searches the QuadTree for elements that are fully contained within the given bound.
              * @param[in] bound The search bound that should contain all the found elements.
-             * @return A std::vector of l_Iter (std::list<T>::iterator) elements, which are valid iterators in the inner
-             *      container of the QuadTree, and which point to the found elements.
+             * @return A std::vector of Handles, which identify the found elements in the inner container of the QuadTree.
+             */
+            virtual std::vector<Handle> queryContain(const qt::Bound &bound) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with each of the given bounds, with a shared traversal.
+             * @param[in] queries The search bounds.
+             * @param[out] result The results of the queries, its previous content is discarded (but its memory is reused).
+             * @note The queries are sorted by the Morton code of their centers, and the spatially close queries are
+             *      answered together (up to 64 at a time), in a single traversal that carries a mask of the queries which
+             *      still overlap a node. So the upper nodes and their items are loaded once for a group, not once per query.
+             *      The own elements of the root are tested against every query, since the elements outside of the bound
+             *      of the QuadTree are kept there.
+             */
+            void queryOverlapBatch(const std::vector<Bound> &queries, BatchResult &result) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with each of the given bounds, using the given working memory.
+             * @param[in] queries The search bounds.
+             * @param[out] result The results of the queries, its previous content is discarded (but its memory is reused).
+             * @param[in,out] scratch The reusable ordering and matches of the batch.
+             */
+            void queryOverlapBatch(const std::vector<Bound> &queries, BatchResult &result, QueryScratch &scratch) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with each of the given bounds, on multiple threads.
+             * @param[in] queries The search bounds.
+             * @param[out] result The results of the queries, the same as with a single thread.
+             * @param[in] threadCount The number of threads (including the calling one), 0 for the number of hardware threads.
+             * @note The groups of queries are taken by the threads one by one from a shared atomic counter, so a thread that is
+             *      done with its group takes the next one, instead of waiting for the others. The tree is only read, so no locking
+             *      is needed, but it mustn't be modified during the call. Every thread collects its matches in its own buffer,
+             *      and the buffers are merged at the end.
+             */
+            void queryOverlapBatch(const std::vector<Bound> &queries, BatchResult &result, unsigned threadCount) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with each of the given bounds, on multiple threads, using the given working memory.
+             * @param[in] queries The search bounds.
+             * @param[out] result The results of the queries.
+             * @param[in,out] scratch The reusable ordering and per-thread matches of the batch.
+             * @param[in] threadCount The number of threads (including the calling one), 0 for the number of hardware threads.
+             */
+            void queryOverlapBatch(const std::vector<Bound> &queries, BatchResult &result, QueryScratch &scratch, unsigned threadCount) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that are fully contained within the given bound, into a caller-owned container.
+             * @param[in] bound The search bound that should contain all the found elements.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             */
+            virtual void queryContain(const qt::Bound &bound, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with the given bound, on multiple threads.
+             * @param[in] bound The search bound that all the found elements should overlap with.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             * @param[in] threadCount The number of threads (including the calling one), 0 for the number of hardware threads.
+             * @note The top levels of the tree are split into the subtrees of their children while they hold enough items,
+             *      and the resulting subtrees are searched in parallel, each into its own buffer. The buffers are appended
+             *      in order at the end, so no locking is needed. Small trees/queries are searched on the calling thread only.
+             */
+            void queryOverlap(const qt::Bound &bound, std::vector<Handle> &foundItems, unsigned threadCount) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that are fully contained within the given bound, on multiple threads.
+             * @param[in] bound The search bound that should contain all the found elements.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             * @param[in] threadCount The number of threads (including the calling one), 0 for the number of hardware threads.
+             * @see QuadTree<T>::queryOverlap(const qt::Bound&, std::vector<Handle>&, unsigned) const
+             */
+            void queryContain(const qt::Bound &bound, std::vector<Handle> &foundItems, unsigned threadCount) const;
+
+            /**
+             * @brief Passes the elements that overlap with the given bound to the callback, one by one.
+             * @param[in] bound The search bound that all the visited elements should overlap with.
+             * @param[in] callback Called with the Handle of each found element. If it returns a value convertible
+             *      to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note Nothing is allocated on the heap, the traversal uses a fixed size stack.
+             */
+            template <typename Callback>
+            bool forEachOverlap(const qt::Bound &bound, Callback callback) const;
+
+            /**
+             * @brief Passes the elements that are fully contained within the given bound to the callback, one by one.
+             * @param[in] bound The search bound that should contain all the visited elements.
+             * @param[in] callback Called with the Handle of each found element. If it returns a value convertible
+             *      to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note Nothing is allocated on the heap, the traversal uses a fixed size stack.
+             */
+            template <typename Callback>
+            bool forEachContain(const qt::Bound &bound, Callback callback) const;
+
+            /**
+             * @brief Passes the elements that overlap with the given bound to the callback, in contiguous ranges of Handles.
+             * @param[in] bound The search bound that all the visited elements should overlap with.
+             * @param[in] callback Called with two const Handle pointers [first, last) for each found range. If it returns
+             *      a value convertible to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note If the QuadTree is packed, a subtree that is fully covered by the bound is passed as a single range,
+             *      without being copied or walked. The ranges are valid until the QuadTree is modified.
+             *      The own elements of the root are always tested one by one, since the elements outside of the tree bound are kept there.
+             * @see QuadTree<T>::pack
+             */
+            template <typename Callback>
+            bool forEachOverlapRange(const qt::Bound &bound, Callback callback) const;
+
+            /**
+             * @brief Passes the elements that are fully contained within the given bound to the callback, in contiguous ranges of Handles.
+             * @param[in] bound The search bound that should contain all the visited elements.
+             * @param[in] callback Called with two const Handle pointers [first, last) for each found range. If it returns
+             *      a value convertible to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note If the QuadTree is packed, a subtree that is fully covered by the bound is passed as a single range.
+             * @see QuadTree<T>::pack
+             */
+            template <typename Callback>
+            bool forEachContainRange(const qt::Bound &bound, Callback callback) const;
+
+            /**
+             * @brief Passes every pair of overlapping elements to the callback, each pair exactly once (e.g. as the broad-phase of collision detection).
+             * @param[in] callback Called with the Handles of the two elements of each pair. If it returns a value convertible
+             *      to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note It is a single pass over the tree: the elements of a node are only tested against each other, and against
+             *      the elements of its ancestors that overlap with the node, so no element is searched from the root again. As the
+             *      quadrons share their edges, the elements touching the dividing lines of a node are also tested across its children.
+             */
+            template <typename Callback>
+            bool forEachOverlappingPair(Callback callback) const;
+
+            /**
+             * @brief Passes every pair of overlapping elements to the callback, each pair exactly once, on multiple threads.
+             * @param[in] callback Called with the Handles of the two elements of each pair. It is called from several threads
+             *      at the same time, so it has to be thread-safe, and its return value is ignored.
+             * @param[in] threadCount The number of threads (including the calling one), 0 for the number of hardware threads.
+             * @note The large subtrees of the top levels are processed in parallel, the same way as in the parallel queries.
              */
-            virtual std::vector<l_Iter> queryContain(const qt::Bound &bound) const;
+            template <typename Callback>
+            void forEachOverlappingPair(Callback callback, unsigned threadCount) const;
+
+            /**
+             * @brief Passes every pair of overlapping elements of two QuadTrees to the callback, each pair exactly once (spatial join).
+             * @param[in] treeA The first QuadTree.
+             * @param[in] treeB The second QuadTree, its bound doesn't have to be the same as the bound of the first one.
+             * @param[in] callback Called with the Handle of the element of treeA and the Handle of the element of treeB of each pair.
+             *      If it returns a value convertible to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note The two trees are walked synchronously, as pairs of nodes: the pairs whose bounds don't overlap are pruned,
+             *      and of an overlapping pair, the larger node is split into its children. The elements of the split node are
+             *      passed down the subtree of the other node, filtered by the bounds of its nodes.
+             */
+            template <typename Callback>
+            static bool spatialJoin(const QuadTree<T> &treeA, const QuadTree<T> &treeB, Callback callback);
+
+            /**
+             * @brief Searches the QuadTree for elements that contain the given point (hit testing).
+             * @param[in] point The point that all the found elements should contain.
+             * @return A std::vector of Handles, which identify the found elements.
+             */
+            std::vector<Handle> queryPoint(const Vec2D_i32 &point) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that contain the given point, into a caller-owned container.
+             * @param[in] point The point that all the found elements should contain.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             * @note Only the path of the nodes that contain the point is descended, choosing the child with one comparison
+             *      per axis, and nothing else is allocated. A point on the dividing line of a node lies in two (or four)
+             *      children, those are all descended. For a point outside of the QuadTree, only the elements of the root
+             *      are checked, as the ones outside of the bound of the QuadTree are stored there.
+             */
+            void queryPoint(const Vec2D_i32 &point, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that are within the given distance of a point (that overlap the circle).
+             * @param[in] center The center of the circle.
+             * @param[in] radius The radius of the circle.
+             * @return A std::vector of Handles, which identify the found elements.
+             */
+            std::vector<Handle> queryRadius(const Vec2D_i32 &center, double radius) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that are within the given distance of a point, into a caller-owned container.
+             * @param[in] center The center of the circle.
+             * @param[in] radius The radius of the circle.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             * @note The children are pruned with the exact distance between their bound and the center, not with the bounding
+             *      square of the circle, so the nodes and elements near the corners of the square are never tested.
+             */
+            void queryRadius(const Vec2D_i32 &center, double radius, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that are within the given distance of a point, together with their distances.
+             * @param[in] center The center of the circle.
+             * @param[in] radius The radius of the circle.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             * @param[out] squaredDistances The squared distance of each found element from the center (see Bound::squaredDistance)
+             *      is appended to it, in the same order as the Handles.
+             */
+            void queryRadius(const Vec2D_i32 &center, double radius, std::vector<Handle> &foundItems, std::vector<int64_t> &squaredDistances) const;
+
+            /**
+             * @brief Searches the QuadTree for the elements that are nearest to the given point.
+             * @param[in] point The point whose neighbours are searched.
+             * @param[in] k The maximal number of elements that should be found.
+             * @param[in] maxDistance Only the elements that are at most this far from the point are found.
+             * @return A std::vector of at most k Handles, ordered by the distance of their elements from the point (nearest first).
+             * @note The distance of an element is the distance of the closest point of its bound, so it is 0 for the elements
+             *      that contain the point. The nodes and the elements are visited best-first (in the order of their distances),
+             *      so the search stops as soon as the k-th element is found, and the farther nodes are never visited.
+             */
+            std::vector<Handle> queryNearest(const Vec2D_i32 &point, std::size_t k, double maxDistance = std::numeric_limits<double>::infinity()) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that are hit by the given ray (or segment), in the order they are hit.
+             * @param[in] origin The starting point of the ray.
+             * @param[in] direction The direction of the ray, the points of the ray are origin + t * direction, for 0 <= t <= maxT.
+             * @param[in] maxT The end of the ray, infinity for an unbounded ray, 1 for the segment from origin to origin + direction.
+             * @return A std::vector of Handles, ordered by the t at which the ray enters the bound of their elements.
+             * @see QuadTree<T>::forEachRayHit
+             */
+            std::vector<Handle> queryRay(const Vec2D_f64 &origin, const Vec2D_f64 &direction, double maxT = std::numeric_limits<double>::infinity()) const;
+
+            /**
+             * @brief Passes the elements that are hit by the given ray (or segment) to the callback, in the order they are hit.
+             * @param[in] origin The starting point of the ray.
+             * @param[in] direction The direction of the ray, the points of the ray are origin + t * direction, for 0 <= t <= maxT.
+             * @param[in] maxT The end of the ray.
+             * @param[in] callback Called with the Handle of each hit element, and the t at which the ray enters its bound. If it
+             *      returns a value convertible to bool, returning false stops the search (e.g. after the first hit).
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note Only the nodes that the ray crosses are visited, front-to-back (in the order the ray enters them),
+             *      and a node is only opened when no element that is hit earlier is left, so stopping after the first hit
+             *      leaves the rest of the path unvisited. The elements are tested with the bounds stored in the nodes.
+             */
+            template <typename Callback>
+            bool forEachRayHit(const Vec2D_f64 &origin, const Vec2D_f64 &direction, double maxT, Callback callback) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with the given region (e.g. a qt::ConvexPolygon).
+             * @tparam Region Any type with a RegionRelation classify(const Bound&) const method.
+             * @param[in] region The search region that all the found elements should overlap with.
+             * @return A std::vector of Handles, which identify the found elements.
+             */
+            template <typename Region>
+            std::vector<Handle> queryRegionOverlap(const Region &region) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with the given region, into a caller-owned container.
+             * @tparam Region Any type with a RegionRelation classify(const Bound&) const method.
+             * @param[in] region The search region that all the found elements should overlap with.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             * @note Every visited node is classified against the region: the subtrees that are outside are skipped, the ones
+             *      that are inside are returned at once (as a single range if the QuadTree is packed), and only the items
+             *      of the partially covered nodes are classified one by one. The own elements of the root are always
+             *      classified one by one, since the elements outside of the bound of the QuadTree are kept there.
+             */
+            template <typename Region>
+            void queryRegionOverlap(const Region &region, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that are fully contained within the given region (e.g. a qt::ConvexPolygon).
+             * @tparam Region Any type with a RegionRelation classify(const Bound&) const method.
+             * @param[in] region The search region that should contain all the found elements.
+             * @return A std::vector of Handles, which identify the found elements.
+             */
+            template <typename Region>
+            std::vector<Handle> queryRegionContain(const Region &region) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that are fully contained within the given region, into a caller-owned container.
+             * @tparam Region Any type with a RegionRelation classify(const Bound&) const method.
+             * @param[in] region The search region that should contain all the found elements.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             */
+            template <typename Region>
+            void queryRegionContain(const Region &region, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief Searches the QuadTree for elements that overlap with the given bound, and satisfy a custom predicate.
+             * @tparam Predicate Any callable type, which is called directly (not through type erasure), so it can be inlined.
+             * @param[in] bound The search bound, only the elements that overlap with it are tested.
+             * @param[in] predicateFn Unary predicate, taking the bound of an element and returning whether it should be returned.
+             * @return A std::vector of Handles, which identify the found elements.
+             * @note The predicate receives the copy of the element's bound that is stored in the tree, the element itself is not read.
+             */
+            template <typename Predicate>
+            std::vector<Handle> queryIf(const qt::Bound &bound, Predicate predicateFn) const;
+
+            /**
+             * @brief Counts the elements of the QuadTree that overlap with the given bound, without collecting them.
+             * @param[in] bound The search bound that all the counted elements should overlap with.
+             * @return The number of elements that queryOverlap would return.
+             * @note A subtree that is fully covered by the bound adds its stored element count at once,
+             *      so only the elements of the nodes on the border of the bound are tested.
+             */
+            std::size_t countOverlap(const qt::Bound &bound) const;
+
+            /**
+             * @brief Counts the elements of the QuadTree that are fully contained within the given bound, without collecting them.
+             * @param[in] bound The search bound that should contain all the counted elements.
+             * @return The number of elements that queryContain would return.
+             * @note A subtree that is fully covered by the bound adds its stored element count at once.
+             */
+            std::size_t countContain(const qt::Bound &bound) const;
 
             /**
              * @brief Removes all elements from the QuadTree that overlap with the given bound.
@@ -88,29 +556,110 @@ namespace qt {
              */
             virtual void removeOverlap(const Bound &bound);
 
+            /**
+             * @brief Removes all elements from the QuadTree that overlap with the given bound, using the given working memory.
+             * @param[in] bound The bound that all the removed elements should overlap with.
+             * @param[in,out] scratch The reusable traversal stacks.
+             */
+            virtual void removeOverlap(const Bound &bound, QueryScratch &scratch);
+
             /**
              * @brief Removes all elements from the QuadTree that are contained within the given bound.
              * @param[in] bound The bound that contains all the elements that should be removed.
              */
             virtual void removeContain(const Bound &bound);
 
+            /**
+             * @brief Removes all elements from the QuadTree that are contained within the given bound, using the given working memory.
+             * @param[in] bound The bound that contains all the elements that should be removed.
+             * @param[in,out] scratch The reusable traversal stacks.
+             */
+            virtual void removeContain(const Bound &bound, QueryScratch &scratch);
+
+            /**
+             * @brief Removes all elements from the QuadTree that overlap with the given bound, on multiple threads.
+             * @param[in] bound The bound that all the removed elements should overlap with.
+             * @param[in] threadCount The number of threads (including the calling one), 0 for the number of hardware threads.
+             * @note The large subtrees of the top levels are processed in parallel, each of them is only modified by its own task.
+             *      The removed elements are erased from the inner container, and the item counts of the top levels are updated
+             *      once all the tasks are done, so no locking is needed.
+             */
+            void removeOverlap(const Bound &bound, unsigned threadCount);
+
+            /**
+             * @brief Removes all elements from the QuadTree that are contained within the given bound, on multiple threads.
+             * @param[in] bound The bound that contains all the elements that should be removed.
+             * @param[in] threadCount The number of threads (including the calling one), 0 for the number of hardware threads.
+             */
+            void removeContain(const Bound &bound, unsigned threadCount);
+
+            /**
+             * @brief Removes all elements from the QuadTree that overlap with the given bound, and satisfy a custom predicate.
+             * @tparam Predicate Any callable type, which is called directly (not through type erasure), so it can be inlined.
+             * @param[in] bound The bound of interest, only the elements that overlap with it are tested.
+             * @param[in] predicateFn Unary predicate, taking the bound of an element and returning whether it should be removed.
+             */
+            template <typename Predicate>
+            void removeIf(const qt::Bound &bound, Predicate predicateFn);
+
+            /**
+             * @brief Lays out the Handles of all the elements in spatial (subtree-contiguous) order, so that the queries
+             *      can return a fully covered subtree as a single range, instead of walking it node by node.
+             * @note It takes linear time, but only if the QuadTree was modified since the last call. Any insertion or removal
+             *      makes the layout outdated, and the queries fall back to walking the covered subtrees until the next call.
+             */
+            void pack();
+
+            /**
+             * @brief Decides whether the QuadTree hasn't been modified since the last call of pack().
+             */
+            bool isPacked() const;
+
             /**
              * @brief Returns all the boundaries that make up the QuadTree.
              * @return A std::vector of qt::Bounds, all the bound objects that make up the inner structure of the QuadTree
              */
             virtual std::vector<qt::Bound> getBounds() const;
 
+            /**
+             * @brief Accesses the element identified by the given Handle.
+             * @param[in] handle A Handle returned by an insertion or a query, whose element hasn't been removed since.
+             * @return A reference to the element.
+             * @note If the bound of the element is modified through the reference, update(handle) has to be
+             *      called afterwards, because the element isn't relocated in the tree structure automatically.
+             */
+            T& operator[](const Handle &handle);
+
+            /**
+             * @brief Accesses the element identified by the given Handle.
+             * @param[in] handle A Handle returned by an insertion or a query, whose element hasn't been removed since.
+             * @return A const reference to the element.
+             */
+            const T& operator[](const Handle &handle) const;
+
+            /**
+             * @brief Decides whether the given Handle still identifies an element of the QuadTree.
+             * @param[in] handle The Handle that needs to be checked.
+             * @return true if the element hasn't been removed yet, false otherwise.
+             */
+            bool contains(const Handle &handle) const;
+
+            /**
+             * @brief Returns the number of elements stored in the QuadTree.
+             */
+            std::size_t size() const;
+
             /**
              * @brief Lambda function, which returns a logical value based on whether Bound "a" overlaps with Bound "b".
              *      It is used as a two operand predicate function for generalizing the query and remove operations
-             *      in the QuadTreeNode class.
+             *      in the QuadTreeNode class. Its closure type is a template argument there, so the call is inlined.
              */
             static constexpr auto overlapFn = [](const qt::Bound &a, const qt::Bound &b) {return a.overlaps(b);};
 
             /**
              * @brief Lambda function, which returns a logical value based on whether Bound "a" contains Bound "b".
              *      It is used as a two operand predicate function for generalizing the query and remove operations
-             *      in the QuadTreeNode class.
+             *      in the QuadTreeNode class. Its closure type is a template argument there, so the call is inlined.
              */
             static constexpr auto containFn = [](const qt::Bound &a, const qt::Bound &b) {return a.contains(b);};
             
@@ -120,18 +669,107 @@ namespace qt {
              */
             class QuadTreeNode;
 
+            /**
+             * @brief Calls the visitor callback with the given arguments, and tells whether the traversal should continue.
+             * @return The result of the callback, or true if the callback returns nothing.
+             */
+            template <typename Callback, typename... Args>
+            static bool invokeCallback(Callback &callback, const Args&... args);
+
+            /**
+             * @brief Calls the visitor callback with each element of the range [first, last), and tells whether the traversal should continue.
+             * @return false if the callback stopped the traversal, true otherwise.
+             */
+            template <typename Callback>
+            static bool invokeForEach(Callback &callback, const Handle *first, const Handle *last);
+
+            /**
+             * @brief Returns the spatially ordered Handles, or nullptr if they are outdated.
+             */
+            const Handle* getPackedItems() const;
+
+            /**
+             * @brief Runs the given number of tasks on the given number of threads (including the calling one).
+             * @param[in] taskCount The number of tasks.
+             * @param[in] threadCount The number of threads, 0 for the number of hardware threads. No more threads are started than tasks.
+             * @param[in] taskFn Called with the index of a task and the index of the thread that runs it. The threads take the next
+             *      task from a shared atomic counter until none is left, so the faster threads take more of them.
+             */
+            template <typename Task>
+            static void runParallel(std::size_t taskCount, unsigned threadCount, Task taskFn);
+
+            /**
+             * @brief Returns the number of threads that should be used for the given number of tasks.
+             * @param[in] taskCount The number of tasks.
+             * @param[in] threadCount The requested number of threads, 0 for the number of hardware threads.
+             */
+            static unsigned getThreadCount(std::size_t taskCount, unsigned threadCount);
+
+            /**
+             * @brief Calculates the Morton (Z-order) code of the center of a bound, on a 2^16 x 2^16 grid over the QuadTree.
+             * @note The bounds that are close to each other usually have close codes, so sorting by the codes groups them.
+             */
+            uint32_t getMortonCode(const Bound &queryBound) const;
+
+            /**
+             * @brief The maximal number of queries that are answered in one traversal of a batch (the bits of a query mask).
+             */
+            static const int BATCHSIZE = 64;
+
             /**
              * @brief The container in which the inserted items are stored.
-             * @note Using an std::vector container is wrong, because upon insertion
-             *      the iterators of its elements can be invalidated. On the other hand,
-             *      std::list guarantees that its iterators will not be invalidated.
+             * @note Using a plain std::vector container is wrong, because upon insertion
+             *      the iterators of its elements can be invalidated. The SlotMap keeps the items
+             *      just as densely, but its Handles are not invalidated.
              */
-            std::list<T> items;
+            SlotMap<T> items;
+
+            /**
+             * @brief The arena from which all the nodes of the tree are allocated, the four children of a node in one block.
+             * @note It must be declared before the root node, because it has to be constructed first.
+             */
+            Arena<QuadTreeNode> nodeArena;
+
+            /**
+             * @brief The bound that contains all the elements of the QuadTree.
+             */
+            qt::Bound bound;
 
             /**
              * @brief The entry point to the inner structure of the tree. It is initialised upon constructing the QuadTree object.
              */
             QuadTreeNode* rootNode;
+
+            /**
+             * @brief The Handles of all the elements in spatial order (a pre-order traversal of the tree), built by pack().
+             */
+            std::vector<Handle> packedItems;
+
+            /**
+             * @brief Whether packedItems is up to date with the tree.
+             */
+            bool packedValid;
+
+            /**
+             * @brief The place of an element in the tree structure.
+             */
+            struct ItemLocation {
+                /**
+                 * @brief The node that stores the element.
+                 */
+                QuadTreeNode *node;
+
+                /**
+                 * @brief The position of the element in the items of the node.
+                 */
+                uint32_t position;
+            };
+
+            /**
+             * @brief The place of each element (back-references from the elements to the tree), indexed by Handle::index.
+             * @note The entries of the removed elements are not cleared, the Handles have to be checked before they are used.
+             */
+            std::vector<ItemLocation> itemLocations;
     };
 
     /**
@@ -139,8 +777,8 @@ namespace qt {
      *      implements the required operations on the QuadTree.
      * @tparam T The type of elements in the QuadTree. It is needed because a QuadTreeNode
      *      can only be interpreted in the context of a QuadTree wrapper.
-     * @note Each node stores iterators to the contained items, and doesn't store the item itself. This
-     *      makes all operations more efficient.
+     * @note Each node stores handles to the contained items (and a copy of their bounds), and doesn't store
+     *      the item itself. This makes all operations more efficient.
      */
     template <typename T>
     class QuadTree<T>::QuadTreeNode {
@@ -149,8 +787,9 @@ namespace qt {
              * @brief Constructs a QuadTreeNode.
              * @param[in] bound The bound that the node fully covers.
              * @param[in] depth The depth of the node in the tree structure.
+             * @param[in] parent The parent of the node, or nullptr for the root.
              */
-            QuadTreeNode(const Bound &bound, int depth = 0);
+            QuadTreeNode(const Bound &bound, int depth = 0, QuadTreeNode* parent = nullptr);
 
             /**
              * @brief No copy constructor.
@@ -167,41 +806,295 @@ namespace qt {
             QuadTreeNode(QuadTreeNode &&other) = delete;
 
             /**
-             * @brief Destroys the tree structure recursively.
+             * @brief Destroys the node.
+             * @note The children of the node are not destroyed, they are owned by the arena of the QuadTree.
              */
             virtual ~QuadTreeNode();                                    
 
             /**
-             * @brief Inserts an iterator to an element in the tree.
-             * @param[in] item An iterator to the element which needs to be inserted in the tree.
-             *          From it it can be deduced the bound of the element.
+             * @brief Inserts a handle to an element in the tree.
+             * @param[in] item A handle to the element which needs to be inserted in the tree.
+             * @param[in] itemBound The bound of the element.
+             * @param[in] nodeArena The arena from which the new nodes on the path of the element are allocated.
+             * @param[out] itemLocations The back-references of the elements, the entry of the element is set.
+             * @return The node in which the handle is stored.
              * @note Instead of the intuitive recursive method, it is implemented in a faster, iterative way.
              * @see QuadTree<T>::insert
              */
-            virtual void insert(const l_Iter &item);
+            virtual QuadTreeNode* insert(const Handle &item, const qt::Bound &itemBound, Arena<QuadTreeNode> &nodeArena, std::vector<ItemLocation> &itemLocations);
+
+            /**
+             * @brief Relocates a handle stored in this node according to the new bound of its element.
+             * @param[in] item The handle of the element, it has to be stored in this node.
+             * @param[in] itemBound The new bound of the element.
+             * @param[in] nodeArena The arena from which the new nodes on the path of the element are allocated.
+             * @param[in,out] itemLocations The back-references of the elements.
+             * @return The node in which the handle is stored afterwards, it is this node iff. it was updated in place.
+             * @see QuadTree<T>::update
+             */
+            QuadTreeNode* update(const Handle &item, const qt::Bound &itemBound, Arena<QuadTreeNode> &nodeArena, std::vector<ItemLocation> &itemLocations);
+
+            /**
+             * @brief Overwrites the stored bound of a handle, if its element still belongs to this node with the new bound.
+             * @param[in] item The handle of the element, it has to be stored in this node.
+             * @param[in] itemBound The new bound of the element.
+             * @param[in] itemLocations The back-references of the elements.
+             * @return true if the bound was overwritten, false if the element has to be relocated.
+             */
+            bool updateInPlace(const Handle &item, const qt::Bound &itemBound, const std::vector<ItemLocation> &itemLocations);
+
+            /**
+             * @brief Removes a handle stored in this node, by moving the last handle of the node in its place.
+             * @param[in] item The handle of the element, it has to be stored in this node.
+             * @param[in,out] itemLocations The back-references of the elements, the entry of the moved element is updated.
+             * @see QuadTree<T>::erase
+             */
+            void erase(const Handle &item, std::vector<ItemLocation> &itemLocations);
+
+            /**
+             * @brief Calculates the locational code of the node (relative to this node) in which the element would be inserted.
+             * @param[in] itemBound The bound of the element.
+             * @return A number in base CELLCODEBASE, one digit for each level below the root, the most significant first.
+             *      The digit of a level is the index of the quadron plus one, or 0 if the element stops above that level.
+             * @note The nodes don't need to exist, only their bounds are calculated. The codes are in pre-order.
+             *      An element that is not inside of the bound of this node gets the code 0, so it is kept in this node.
+             */
+            uint32_t getCellCode(const qt::Bound &itemBound) const;
+
+            /**
+             * @brief Loads the given elements in the subtree of this node at once.
+             * @param[in] itemContainer The outer container of the elements.
+             * @param[in] first The beginning of the range of the Handles of the elements.
+             * @param[in] last The end of the range of the Handles of the elements.
+             * @param[in] nodeArena The arena from which the new nodes are allocated.
+             * @param[out] itemLocations The back-references of the elements are set.
+             * @see QuadTree<T>::build
+             */
+            void build(const SlotMap<T> &itemContainer, const Handle *first, const Handle *last, Arena<QuadTreeNode> &nodeArena,
+                std::vector<ItemLocation> &itemLocations);
 
              /**
              * @brief Searches the tree for elements that overlap with/are contained in the given bound, based on the binary predicate function.
+             * @tparam wholeNodeMatch Whether all the elements of a node that is fully contained in the bound satisfy the predicate
+             *          (as with overlapFn and containFn), so that they can be returned without being tested.
+             * @tparam Predicate The type of the predicate, any callable type.
              * @param[in] bound The search bound that all the found elements should overlap with/be contained in.
-             * @param[out] foundItems The std::vector of std::list<T>::iterators, which point
-             *          to the found elements, and which are valid in the context of the QuadTree classes container.
+             * @param[out] foundItems The std::vector of Handles, which identify the found elements,
+             *          and which are valid in the context of the QuadTree classes container.
              * @param[in] predicateFn Binary predicate function, taking two Bound arguments and returning whether they are in a certain relation or not.
+             * @param[in] packedItems The spatially ordered Handles of the QuadTree, or nullptr if they are outdated.
              * @note Instead of the intuitive recursive method, it is implemented in a faster, iterative way.
              * @see QuadTree<T>::queryOverlap
              * @see QuadTree<T>::queryContain
              */
-            virtual void query(const qt::Bound &bound, std::vector<l_Iter> &foundItems, const std::function<bool (const qt::Bound&, const qt::Bound&)> &predicateFn) const;
+            template <bool wholeNodeMatch, typename Predicate>
+            void query(const qt::Bound &bound, std::vector<Handle> &foundItems, Predicate predicateFn, const Handle* packedItems) const;
+
+            /**
+             * @brief Visits the elements of the tree that overlap with/are contained in the given bound, based on the binary predicate function.
+             * @tparam wholeNodeMatch Whether all the elements of a node that is fully contained in the bound satisfy the predicate.
+             * @param[in] bound The search bound that all the visited elements should overlap with/be contained in.
+             * @param[in] predicateFn Binary predicate function, taking two Bound arguments.
+             * @param[in] rangeCallback Called with a [first, last) range of Handles for each found range, it can stop the traversal by returning false.
+             * @param[in] packedItems The spatially ordered Handles of the QuadTree, or nullptr if they are outdated.
+             * @return false if the traversal was stopped by the callback, true otherwise.
+             * @note The traversal is a DFS with a fixed size stack, so it doesn't allocate.
+             * @see QuadTree<T>::forEachOverlap
+             * @see QuadTree<T>::forEachContain
+             */
+            template <bool wholeNodeMatch, typename Predicate, typename RangeCallback>
+            bool visit(const qt::Bound &bound, Predicate predicateFn, RangeCallback &rangeCallback, const Handle* packedItems) const;
+
+            /**
+             * @brief Visits the elements of the tree that overlap with/are contained in the given region.
+             * @tparam containItems Whether the elements should be contained in the region, instead of overlapping with it.
+             * @tparam Region Any type with a RegionRelation classify(const Bound&) const method.
+             * @param[in] region The search region.
+             * @param[in] rangeCallback Called with a [first, last) range of Handles for each found range, it can stop the traversal by returning false.
+             * @param[in] packedItems The spatially ordered Handles of the QuadTree, or nullptr if they are outdated.
+             * @return false if the traversal was stopped by the callback, true otherwise.
+             * @see QuadTree<T>::queryRegionOverlap
+             * @see QuadTree<T>::queryRegionContain
+             */
+            template <bool containItems, typename Region, typename RangeCallback>
+            bool visitRegion(const Region &region, RangeCallback &rangeCallback, const Handle* packedItems) const;
+
+            /**
+             * @brief Searches the tree for elements that overlap with a group of bounds, in a single traversal.
+             * @param[in] queries The bounds of the group, at most BATCHSIZE.
+             * @param[in] queryIndices The index of each bound of the group in the whole batch.
+             * @param[in] queryCount The number of bounds in the group.
+             * @param[out] matches The (query index, Handle) pairs of the found elements are appended to it.
+             * @param[in] packedItems The spatially ordered Handles of the QuadTree, or nullptr if they are outdated.
+             * @see QuadTree<T>::queryOverlapBatch
+             */
+            void queryBatch(const Bound *queries, const uint32_t *queryIndices, int queryCount,
+                std::vector<std::pair<uint32_t, Handle>> &matches, const Handle* packedItems) const;
+
+            /**
+             * @brief Counts the elements of the tree that overlap with/are contained in the given bound, based on the binary predicate function.
+             * @tparam wholeNodeMatch Whether all the elements of a node that is fully contained in the bound satisfy the predicate,
+             *          so that the subtree count of the node can be used instead of testing its elements.
+             * @param[in] bound The search bound that all the counted elements should overlap with/be contained in.
+             * @param[in] predicateFn Binary predicate function, taking two Bound arguments.
+             * @return The number of the found elements.
+             * @see QuadTree<T>::countOverlap
+             * @see QuadTree<T>::countContain
+             */
+            template <bool wholeNodeMatch, typename Predicate>
+            std::size_t count(const qt::Bound &bound, Predicate predicateFn) const;
+
+            /**
+             * @brief Visits the elements of the tree that are hit by the given ray, in the order they are hit (best-first by the entry t).
+             * @param[in] origin The starting point of the ray.
+             * @param[in] direction The direction of the ray.
+             * @param[in] maxT The end of the ray.
+             * @param[in] callback Called with the Handle of each hit element and its entry t, it can stop the traversal by returning false.
+             * @return false if the traversal was stopped by the callback, true otherwise.
+             * @see QuadTree<T>::forEachRayHit
+             */
+            template <typename Callback>
+            bool visitRay(const Vec2D_f64 &origin, const Vec2D_f64 &direction, double maxT, Callback &callback) const;
+
+            /**
+             * @brief Visits the elements of the tree that are within the given squared distance of a point.
+             * @param[in] center The center of the circle.
+             * @param[in] maxSquaredDistance The squared radius of the circle.
+             * @param[in] callback Called with the Handle of each found element and its squared distance from the center.
+             * @see QuadTree<T>::queryRadius
+             */
+            template <typename Callback>
+            void visitRadius(const Vec2D_i32 &center, double maxSquaredDistance, Callback &callback) const;
+
+            /**
+             * @brief Searches the tree for elements that contain the given point, descending only the nodes that contain it.
+             * @param[in] point The point that all the found elements should contain.
+             * @param[out] foundItems The Handles of the found elements are appended to it.
+             * @see QuadTree<T>::queryPoint
+             */
+            void queryPoint(const Vec2D_i32 &point, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief Searches the tree for the elements that are nearest to the given point, in a best-first order.
+             * @param[in] point The point whose neighbours are searched.
+             * @param[in] k The maximal number of elements that should be found.
+             * @param[in] maxSquaredDistance Only the elements whose squared distance is at most this are found.
+             * @param[out] foundItems The Handles of the found elements are appended to it, nearest first.
+             * @see QuadTree<T>::queryNearest
+             */
+            void nearest(const Vec2D_i32 &point, std::size_t k, double maxSquaredDistance, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief The elements of the ancestors of a node that may overlap with the elements of its subtree, during a pair search.
+             */
+            typedef std::vector<std::pair<Handle, qt::Bound>> AncestorItems;
+
+            /**
+             * @brief Visits the pairs of overlapping elements in which one element is stored in the node itself, and the pairs
+             *      whose elements are stored in the subtrees of two different children (these can only touch on the dividing lines).
+             * @param[in,out] ancestors The elements of the ancestors, from ancestorBegin. Those that overlap with the node are appended
+             *      to it, followed by the elements of the node itself, these are the ancestors of the children.
+             * @param[in] ancestorBegin The index of the first element of the ancestors in the container.
+             * @param[in] callback Called with the Handles of each pair, returns whether the search should continue.
+             * @return false if the search was stopped by the callback, true otherwise.
+             */
+            template <typename Callback>
+            bool visitNodePairs(AncestorItems &ancestors, std::size_t ancestorBegin, Callback &callback) const;
+
+            /**
+             * @brief Collects the elements of the subtree that overlap with either of the two lines (that divide an ancestor in four).
+             * @param[in] verticalLine The vertical dividing line, as a bound with zero width.
+             * @param[in] horizontalLine The horizontal dividing line, as a bound with zero height.
+             * @param[out] edgeItems The found elements are appended to it.
+             */
+            void collectEdgeItems(const qt::Bound &verticalLine, const qt::Bound &horizontalLine, AncestorItems &edgeItems) const;
+
+            /**
+             * @brief Visits the pairs of overlapping elements in which at least one element is stored in the subtree of the node.
+             * @param[in,out] ancestors The elements of the ancestors, from ancestorBegin, it is restored before returning.
+             * @param[in] ancestorBegin The index of the first element of the ancestors in the container.
+             * @param[in] callback Called with the Handles of each pair, returns whether the search should continue.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @see QuadTree<T>::forEachOverlappingPair
+             */
+            template <typename Callback>
+            bool visitPairs(AncestorItems &ancestors, std::size_t ancestorBegin, Callback &callback) const;
+
+            /**
+             * @brief Visits the pairs of overlapping elements of the tree, processing the large subtrees in parallel.
+             * @param[in] callback Called with the Handles of each pair, from several threads.
+             * @param[in] threadCount The number of threads (including the calling one).
+             * @see QuadTree<T>::forEachOverlappingPair
+             */
+            template <typename Callback>
+            void parallelPairs(Callback &callback, unsigned threadCount) const;
+
+            /**
+             * @brief Visits the pairs of overlapping elements, in which one element is one of the given candidates (from another tree),
+             *      and the other one is stored in the subtree of the node.
+             * @tparam swapped Whether the Handle of the candidate is the second argument of the callback (instead of the first).
+             * @param[in,out] candidates The candidate elements, from candidateBegin, it is restored before returning.
+             * @param[in] candidateBegin The index of the first candidate in the container.
+             * @param[in] callback Called with the Handles of each pair, returns whether the search should continue.
+             * @return false if the search was stopped by the callback, true otherwise.
+             */
+            template <bool swapped, typename Callback>
+            bool visitCandidates(AncestorItems &candidates, std::size_t candidateBegin, Callback &callback) const;
+
+            /**
+             * @brief Visits the pairs of overlapping elements, in which one element is stored in the subtree of this node, and the
+             *      other one is stored in the subtree of the other node (from another tree).
+             * @param[in] other The root of the subtree of the other tree.
+             * @param[in] callback Called with the Handle of this tree's element and the Handle of the other tree's element of each pair.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @see QuadTree<T>::spatialJoin
+             */
+            template <typename Callback>
+            bool join(const QuadTreeNode &other, Callback &callback) const;
 
             /**
              * @brief Removes the elements from the tree that overlap with/are contained in the given bound, based on the binary predicate function.
+             * @tparam wholeNodeMatch Whether all the elements of a node that is fully contained in the bound satisfy the predicate
+             *          (as with overlapFn and containFn), so that they can be removed without being tested.
+             * @tparam Predicate The type of the predicate, any callable type.
+             * @tparam RemovedCallback The type of the callback, any callable type.
              * @param[in] bound The search bound that all the found elements should overlap with/be contained in.
-             * @param[out] itemContainer itemContainer A pointer to the outter container in which the elements' iterators have context.
+             * @param[in] removedFn Called with the Handle of each element that is removed from the tree, it should remove it from the outer container.
              * @param[in] predicateFn Binary predicate function, taking two Bound arguments and returning whether they are in a certain relation or not.
+             * @param[in,out] scratch The traversal stacks, their previous content is discarded.
+             * @param[in,out] itemLocations The back-references of the elements, the positions of the remaining elements are updated.
              * @note Instead of the intuitive recursive method, it is implemented in a faster, iterative way.
+             * @note Only the subtree of "this" node is modified (the item counts of its ancestors too, and the back-references of
+             *      its elements), so the disjoint subtrees can be processed in parallel, if the callbacks don't share the outer container.
              * @see QuadTree<T>::removeOverlap
              * @see QuadTree<T>::removeContain
              */
-            virtual void remove(const qt::Bound bound, std::list<T>* itemContainer, const std::function<bool (const qt::Bound&, const qt::Bound&)> &predicateFn);
+            template <bool wholeNodeMatch, typename Predicate, typename RemovedCallback>
+            void remove(const qt::Bound bound, RemovedCallback removedFn, Predicate predicateFn, QueryScratch &scratch, std::vector<ItemLocation> &itemLocations);
+
+            /**
+             * @brief Searches the tree for elements that overlap with/are contained in the given bound, processing the large subtrees in parallel.
+             * @param[in] bound The search bound.
+             * @param[out] foundItems The Handles of the found elements are appended to it.
+             * @param[in] predicateFn Binary predicate function, taking two Bound arguments.
+             * @param[in] packedItems The spatially ordered Handles of the QuadTree, or nullptr if they are outdated.
+             * @param[in] threadCount The number of threads (including the calling one).
+             * @see QuadTree<T>::queryOverlap
+             */
+            template <bool wholeNodeMatch, typename Predicate>
+            void parallelQuery(const qt::Bound &bound, std::vector<Handle> &foundItems, Predicate predicateFn, const Handle* packedItems, unsigned threadCount) const;
+
+            /**
+             * @brief Removes the elements from the tree that overlap with/are contained in the given bound, processing the large subtrees in parallel.
+             * @param[in] bound The search bound.
+             * @param[out] itemContainer A pointer to the outer container, the removed elements are erased from it after the parallel part.
+             * @param[in] predicateFn Binary predicate function, taking two Bound arguments.
+             * @param[in] threadCount The number of threads (including the calling one).
+             * @param[in,out] itemLocations The back-references of the elements.
+             * @see QuadTree<T>::removeOverlap
+             */
+            template <bool wholeNodeMatch, typename Predicate>
+            void parallelRemove(const qt::Bound &bound, SlotMap<T>* itemContainer, Predicate predicateFn, unsigned threadCount, std::vector<ItemLocation> &itemLocations);
 
              /**
              * @brief Returns all the boundaries that make up the tree.
@@ -211,6 +1104,13 @@ namespace qt {
              */
             virtual void getBounds(std::vector<Bound> &bounds) const;
 
+            /**
+             * @brief Appends the Handles of the subtree to the spatially ordered container, and records the range of the subtree.
+             * @param[out] packedItems The spatially ordered Handles of the QuadTree.
+             * @see QuadTree<T>::pack
+             */
+            void pack(std::vector<Handle> &packedItems);
+
         protected:
             /**
              * @brief Static constant in all QuadTreeNode instances. It represents the maximal depth (plus 1)
@@ -220,6 +1120,93 @@ namespace qt {
              */
             static const int MAXDEPTH = 6;
 
+            /**
+             * @brief The size of the traversal stack of a search. Every visited node is replaced
+             *      by at most four children, so the stack grows by at most 3 entries per level.
+             */
+            static const int MAXSTACKSIZE = 3 * (MAXDEPTH - 1) + 1;
+
+            /**
+             * @brief The parallel searches split a node into its children (instead of processing it as one task) only
+             *      if it has at least this many items in its subtree, and it is above the FORKDEPTH level.
+             * @note With FORKDEPTH = 2, there are at most 16 tasks, the subtrees of the nodes on the second level.
+             */
+            static const std::size_t PARALLELTHRESHOLD = 8192;
+            static const int FORKDEPTH = 2;
+
+            /**
+             * @brief The base of the digits of the locational codes of the bulk loading (4 quadrons, and 0 for "stop"),
+             *      and the number of different codes of the root, which has MAXDEPTH - 1 levels below it.
+             */
+            static const uint32_t CELLCODEBASE = 5;
+            static const uint32_t CELLCODECOUNT = CELLCODEBASE * CELLCODEBASE * CELLCODEBASE * CELLCODEBASE * CELLCODEBASE;
+            static_assert(MAXDEPTH == 6, "CELLCODECOUNT has to be CELLCODEBASE ^ (MAXDEPTH - 1).");
+            static_assert(CELLCODECOUNT <= 65536, "The locational codes are stored in 16 bits.");
+
+            /**
+             * @brief An entry of the traversal stack of a search.
+             */
+            struct NodeVisit {
+                /**
+                 * @brief The node that needs to be visited.
+                 */
+                const QuadTreeNode* node;
+
+                /**
+                 * @brief Whether the node lies within a subtree whose all items have to be returned.
+                 */
+                bool allItems;
+            };
+
+            /**
+             * @brief An entry of the traversal stack of a batched search.
+             */
+            struct BatchVisit {
+                /**
+                 * @brief The node that needs to be visited.
+                 */
+                const QuadTreeNode* node;
+
+                /**
+                 * @brief The i-th bit is set if the i-th query of the group overlaps the node, but doesn't contain it.
+                 */
+                uint64_t partialMask;
+
+                /**
+                 * @brief The i-th bit is set if the i-th query of the group contains the node (or one of its ancestors).
+                 */
+                uint64_t allMask;
+            };
+
+            /**
+             * @brief An entry of the priority queue of a best-first search (nearest neighbours, ray hits):
+             *      either a node or an element, together with its key (its distance along the search).
+             * @tparam Key The type of the key, the entry with the smallest key is visited first.
+             */
+            template <typename Key>
+            struct BestFirstVisit {
+                /**
+                 * @brief The distance of the bound of the node/element, the order of the search.
+                 */
+                Key key;
+
+                /**
+                 * @brief The node that needs to be visited, or nullptr if the entry is an element.
+                 */
+                const QuadTreeNode* node;
+
+                /**
+                 * @brief The Handle of the element, if the entry is an element.
+                 */
+                Handle item;
+
+                /**
+                 * @brief Orders the entries for a min-heap: the farther entry is the "lesser", and an element comes
+                 *      before a node of the same distance, so that it can be returned without visiting the node.
+                 */
+                bool operator<(const BestFirstVisit &other) const;
+            };
+
             /**
              * @brief Tells wether the node is a leaf or node.
              */
@@ -237,20 +1224,141 @@ namespace qt {
             qt::Bound bound;                                                     
             
             /**
-             * @brief A list of iterators that point to the elements stored in the node.
+             * @brief The handles that identify the elements stored in the node, together with the bounds of the elements.
+             * @note Because the bounds are stored inline, the node can be searched without touching the elements.
              */
-            std::vector<l_Iter> items;
+            ItemBucket<Handle> items;
             
             /**
-             * @brief Pointers to the children nodes of the node.
+             * @brief Pointer to the four children nodes of the node (in NW, NE, SW, SE order),
+             *      which are allocated together, or nullptr if the node hasn't been divided yet.
+             */
+            QuadTreeNode* children;
+
+            /**
+             * @brief Pointer to the parent of the node, or nullptr for the root.
              */
-            QuadTreeNode* children[4];
+            QuadTreeNode* parent;
+
+            /**
+             * @brief The number of elements stored in the subtree of the node (in the node itself and in all of its descendants).
+             * @note It is kept up to date by the insertions and removals.
+             */
+            std::size_t itemCount;
 
             /**
              * @brief The four subdivisions (quadrons) of the node.
              */                                
             std::array<qt::Bound, 4> childrenBounds;
+
+            /**
+             * @brief The range [packedBegin, packedEnd) of the subtree in the spatially ordered Handles of the QuadTree.
+             * @note Only valid while the QuadTree is packed.
+             */
+            std::size_t packedBegin;
+            std::size_t packedEnd;
+    };
+
+    /**
+     * @brief Inner struct of QuadTree, the reusable working memory of the removals and of the batched queries.
+     * @tparam T The type of elements in the QuadTree.
+     */
+    template <typename T>
+    struct QuadTree<T>::QueryScratch {
+        /**
+         * @brief The nodes that are still to be inspected.
+         */
+        std::vector<QuadTreeNode*> nodeStack;
+
+        /**
+         * @brief The nodes whose all items have to be removed.
+         */
+        std::vector<QuadTreeNode*> allItemNodeStack;
+
+        /**
+         * @brief The (Morton code, index) pairs of the queries of a batch, sorted by the codes.
+         */
+        std::vector<std::pair<uint32_t, uint32_t>> batchOrder;
+
+        /**
+         * @brief The sorted bounds and indices of the queries of a batch.
+         */
+        std::vector<Bound> batchQueries;
+        std::vector<uint32_t> batchIndices;
+
+        /**
+         * @brief The (query index, Handle) pairs found by each thread of a batch, before they are grouped by the queries.
+         */
+        std::vector<std::vector<std::pair<uint32_t, Handle>>> batchMatches;
+    };
+
+    /**
+     * @brief Inner struct of QuadTree, the mutations collected to be applied together.
+     * @tparam T The type of elements in the QuadTree.
+     */
+    template <typename T>
+    struct QuadTree<T>::Batch {
+        /**
+         * @brief The elements that need to be inserted, in the order of the insertions.
+         */
+        std::vector<T> insertions;
+
+        /**
+         * @brief The Handles of the elements that need to be replaced, together with their new values.
+         */
+        std::vector<std::pair<Handle, T>> updates;
+
+        /**
+         * @brief The Handles of the elements that need to be removed.
+         */
+        std::vector<Handle> erasures;
+
+        /**
+         * @brief Collects the insertion of an element.
+         * @param[in] itemWithBound An element with type T, which needs to be inserted into the QuadTree.
+         */
+        void insert(const T &itemWithBound);
+        void insert(T &&itemWithBound);
+
+        /**
+         * @brief Collects the insertion of an element, constructed in place from the given arguments.
+         * @param[in] args The arguments forwarded to the constructor of T.
+         */
+        template <typename... Args>
+        void emplace(Args&&... args);
+
+        /**
+         * @brief Collects the replacement of an element.
+         * @param[in] handle The Handle of the element.
+         * @param[in] itemWithBound The new value of the element.
+         */
+        void update(const Handle &handle, const T &itemWithBound);
+        void update(const Handle &handle, T &&itemWithBound);
+
+        /**
+         * @brief Collects the removal of an element.
+         * @param[in] handle The Handle of the element that needs to be removed.
+         */
+        void erase(const Handle &handle);
+
+        /**
+         * @brief Returns the number of collected mutations.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Decides whether no mutations have been collected.
+         */
+        bool empty() const;
+
+        /**
+         * @brief Discards all the collected mutations.
+         */
+        void clear();
     };
 }
 
+// The template definitions, so that the class can be used header-only, without explicit instantiation
+#include "quadtree.tpp"
+
 #endif
\ No newline at end of file
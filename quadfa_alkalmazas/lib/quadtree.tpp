@@ -0,0 +1,1888 @@
+#include "quadtree.hpp"     // class declarations
+
+#include <queue>            // std::queue, std::priority_queue
+#include <new>              // placement new
+#include <array>            // std::array
+#include <algorithm>        // std::sort, std::min, std::max
+#include <thread>           // std::thread
+#include <atomic>           // std::atomic
+#include <iterator>         // std::iterator_traits, std::distance
+#include <utility>          // std::move, std::forward
+
+namespace qt {
+    /*------------------------------------------------
+            QuadTree template class implementation
+    --------------------------------------------------*/
+
+    // Constructs an empty QuadTree in the given bound.
+    template <typename T>
+    QuadTree<T>::QuadTree(const Bound &bound) : bound(bound), packedValid(false) {
+        // Constructs the root of the tree structure in the arena
+        rootNode = new (nodeArena.allocate(1)) QuadTreeNode(bound);
+    }
+
+    // Constructs a QuadTree in the given bound, and loads the elements of the range at once.
+    template <typename T>
+    template <typename InputIt>
+    QuadTree<T>::QuadTree(const Bound &bound, InputIt first, InputIt last) : QuadTree(bound) {
+        build(first, last);
+    }
+
+    // Destructs the QuadTree.
+    template <typename T>
+    QuadTree<T>::~QuadTree() {
+        // The arena releases the entire tree structure at once
+        // No need for freeing other members, they have their own deallocators
+    }
+
+    // Removes all the elements from the QuadTree.
+    template <typename T>
+    void QuadTree<T>::clear() {
+        // Release all the nodes at once, then construct a new, empty root
+        items.clear();
+        itemLocations.clear();
+        nodeArena.clear();
+        rootNode = new (nodeArena.allocate(1)) QuadTreeNode(bound);
+        packedValid = false;
+    }
+    
+    // Removes all the elements from the QuadTree, and loads the elements of the range at once.
+    template <typename T>
+    template <typename InputIt>
+    void QuadTree<T>::build(InputIt first, InputIt last) {
+        std::vector<Handle> handles;
+        build(first, last, handles);
+    }
+
+    // Removes all the elements from the QuadTree, and loads the elements of the range at once, returning their Handles.
+    template <typename T>
+    template <typename InputIt>
+    void QuadTree<T>::build(InputIt first, InputIt last, std::vector<Handle> &handles) {
+        clear();
+
+        // If the size of the range is known in advance, allocate everything at once
+        if constexpr (std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value) {
+            const std::size_t count = std::distance(first, last);
+            items.reserve(count);
+            handles.reserve(handles.size() + count);
+        }
+
+        // Store the elements in the main container (the range is only traversed once)
+        const std::size_t firstHandle = handles.size();
+        for(; first != last; ++first) {
+            Handle handle = items.insert(*first);
+            handles.push_back(handle);
+            if(itemLocations.size() <= handle.index) {
+                itemLocations.resize(handle.index + 1);
+            }
+        }
+
+        // Then build the tree structure from the root
+        rootNode->build(items, handles.data() + firstHandle, handles.data() + handles.size(), nodeArena, itemLocations);
+    }
+
+    // Inserts an element into the QuadTree.
+    template <typename T>
+    typename QuadTree<T>::Handle QuadTree<T>::insert(const T &itemWithBound) {
+        return emplace(itemWithBound);
+    }
+
+    // Inserts an element into the QuadTree, by moving it into the main container.
+    template <typename T>
+    typename QuadTree<T>::Handle QuadTree<T>::insert(T &&itemWithBound) {
+        return emplace(std::move(itemWithBound));
+    }
+
+    // Inserts an element into the QuadTree, constructed in place in the main container.
+    template <typename T>
+    template <typename... Args>
+    typename QuadTree<T>::Handle QuadTree<T>::emplace(Args&&... args) {
+        // First, construct the item in the main container, which gives a handle to it.
+        // Then insert the handle in the tree structure, with the bound of the stored item.
+        Handle handle = items.emplace(std::forward<Args>(args)...);
+        if(itemLocations.size() <= handle.index) {
+            itemLocations.resize(handle.index + 1);
+        }
+        rootNode->insert(handle, items[handle], nodeArena, itemLocations);
+        packedValid = false;
+        return handle;
+    }
+
+    // Inserts the elements of the range into the QuadTree one by one, keeping the existing elements.
+    template <typename T>
+    template <typename InputIt>
+    void QuadTree<T>::insert(InputIt first, InputIt last, std::vector<Handle> &handles) {
+        for(; first != last; ++first) {
+            handles.push_back(emplace(*first));
+        }
+    }
+
+    // Replaces an element of the QuadTree, and relocates it in the tree structure according to its new bound.
+    template <typename T>
+    bool QuadTree<T>::update(const Handle &handle, const T &itemWithBound) {
+        if(!items.contains(handle)) {
+            return false;
+        }
+        items[handle] = itemWithBound;
+        return update(handle);
+    }
+
+    // Relocates an element in the tree structure, after its bound has been modified.
+    template <typename T>
+    bool QuadTree<T>::update(const Handle &handle) {
+        if(!items.contains(handle)) {
+            return false;
+        }
+
+        // An element updated in place keeps the spatial layout valid, as the set of handles of every subtree is the same
+        QuadTreeNode *itemNode = itemLocations[handle.index].node;
+        if(itemNode->update(handle, items[handle], nodeArena, itemLocations) != itemNode) {
+            packedValid = false;
+        }
+        return true;
+    }
+
+    // Removes a single element from the QuadTree.
+    template <typename T>
+    bool QuadTree<T>::erase(const Handle &handle) {
+        if(!items.contains(handle)) {
+            return false;
+        }
+        itemLocations[handle.index].node->erase(handle, itemLocations);
+        items.erase(handle);
+        packedValid = false;
+        return true;
+    }
+
+    // Applies all the mutations of a Batch at once.
+    template <typename T>
+    void QuadTree<T>::apply(Batch &batch) {
+        std::vector<Handle> insertedHandles;
+        apply(batch, insertedHandles);
+    }
+
+    // Applies all the mutations of a Batch at once, returning the Handles of the inserted elements.
+    template <typename T>
+    void QuadTree<T>::apply(Batch &batch, std::vector<Handle> &insertedHandles) {
+        // The removals come first, so that the updates of the removed elements are skipped
+        for(const Handle &handle : batch.erasures) {
+            erase(handle);
+        }
+
+        // Store the new values before relocating anything, so that only the last value of an element counts
+        for(auto &update : batch.updates) {
+            if(items.contains(update.first)) {
+                items[update.first] = std::move(update.second);
+            }
+        }
+
+        // The elements that stay in their nodes are updated in place, the others are taken out of the tree, to be loaded
+        // together with the insertions (their node is cleared, so that a repeatedly updated element is only taken out once)
+        std::vector<Handle> loadedItems;
+        for(const auto &update : batch.updates) {
+            const Handle &handle = update.first;
+            if(!items.contains(handle) || !itemLocations[handle.index].node) {
+                continue;
+            }
+            QuadTreeNode *itemNode = itemLocations[handle.index].node;
+            if(!itemNode->updateInPlace(handle, items[handle], itemLocations)) {
+                itemNode->erase(handle, itemLocations);
+                itemLocations[handle.index].node = nullptr;
+                loadedItems.push_back(handle);
+            }
+        }
+
+        // The inserted elements are stored in the main container one by one
+        for(T &itemWithBound : batch.insertions) {
+            Handle handle = items.insert(std::move(itemWithBound));
+            if(itemLocations.size() <= handle.index) {
+                itemLocations.resize(handle.index + 1);
+            }
+            insertedHandles.push_back(handle);
+            loadedItems.push_back(handle);
+        }
+
+        // But they are linked into the tree structure at once, sorted by their target nodes
+        if(!loadedItems.empty()) {
+            rootNode->build(items, loadedItems.data(), loadedItems.data() + loadedItems.size(), nodeArena, itemLocations);
+            packedValid = false;
+        }
+        batch.clear();
+    }
+
+    // Searches the QuadTree for elements that overlap with the given bound.
+    template <typename T>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryOverlap(const Bound &bound) const {
+        std::vector<Handle> foundItems;
+        queryOverlap(bound, foundItems);
+        return foundItems;                              
+    }
+
+    // Searches the QuadTree for elements that overlap with the given bound, appending them to the given container.
+    template <typename T>
+    void QuadTree<T>::queryOverlap(const Bound &bound, std::vector<Handle> &foundItems) const {
+        // Call the generic query method of the node class, but with the overlapFn predicate.
+        rootNode->template query<true>(bound, foundItems, overlapFn, getPackedItems());
+    }
+
+    // Searches the QuadTree for elements that overlap with the given bound, on multiple threads.
+    template <typename T>
+    void QuadTree<T>::queryOverlap(const Bound &bound, std::vector<Handle> &foundItems, unsigned threadCount) const {
+        rootNode->template parallelQuery<true>(bound, foundItems, overlapFn, getPackedItems(), threadCount);
+    }
+
+    // Searches the QuadTree for elements that overlap with each of the given bounds, with a shared traversal.
+    template <typename T>
+    void QuadTree<T>::queryOverlapBatch(const std::vector<Bound> &queries, BatchResult &result) const {
+        QueryScratch scratch;
+        queryOverlapBatch(queries, result, scratch);
+    }
+
+    // Searches the QuadTree for elements that overlap with each of the given bounds, using the given working memory.
+    template <typename T>
+    void QuadTree<T>::queryOverlapBatch(const std::vector<Bound> &queries, BatchResult &result, QueryScratch &scratch) const {
+        queryOverlapBatch(queries, result, scratch, 1);
+    }
+
+    // Searches the QuadTree for elements that overlap with each of the given bounds, on multiple threads.
+    template <typename T>
+    void QuadTree<T>::queryOverlapBatch(const std::vector<Bound> &queries, BatchResult &result, unsigned threadCount) const {
+        QueryScratch scratch;
+        queryOverlapBatch(queries, result, scratch, threadCount);
+    }
+
+    // Searches the QuadTree for elements that overlap with each of the given bounds, on multiple threads, using the given working memory.
+    template <typename T>
+    void QuadTree<T>::queryOverlapBatch(const std::vector<Bound> &queries, BatchResult &result, QueryScratch &scratch, unsigned threadCount) const {
+        const std::size_t queryCount = queries.size();
+
+        // Sort the queries by the Morton codes of their centers, so that the groups are spatially coherent
+        std::vector<std::pair<uint32_t, uint32_t>> &order = scratch.batchOrder;
+        order.clear();
+        for(std::size_t i = 0; i < queryCount; i++) {
+            order.push_back(std::make_pair(getMortonCode(queries[i]), uint32_t(i)));
+        }
+        std::sort(order.begin(), order.end());
+
+        scratch.batchQueries.clear();
+        scratch.batchIndices.clear();
+        for(const auto &entry : order) {
+            scratch.batchQueries.push_back(queries[entry.second]);
+            scratch.batchIndices.push_back(entry.second);
+        }
+
+        // Every thread has its own buffer of matches
+        const std::size_t groupCount = (queryCount + BATCHSIZE - 1) / BATCHSIZE;
+        threadCount = getThreadCount(groupCount, threadCount);
+        std::vector<std::vector<std::pair<uint32_t, Handle>>> &matches = scratch.batchMatches;
+        if(matches.size() < threadCount) {
+            matches.resize(threadCount);
+        }
+        for(unsigned t = 0; t < threadCount; t++) {
+            matches[t].clear();
+        }
+
+        // Answer the groups of neighbouring queries, one traversal per group
+        const Handle *packed = getPackedItems();
+        runParallel(groupCount, threadCount, [&](std::size_t group, unsigned threadIndex) {
+            std::size_t first = group * BATCHSIZE;
+            int groupSize = int(std::min<std::size_t>(BATCHSIZE, queryCount - first));
+            rootNode->queryBatch(&scratch.batchQueries[first], &scratch.batchIndices[first], groupSize, matches[threadIndex], packed);
+        });
+
+        // Group the matches of all the threads by the queries with a counting sort: count them, take the prefix sums
+        // as the starts of the groups, and place every match at the next free position of its group
+        result.offsets.assign(queryCount + 1, 0);
+        for(unsigned t = 0; t < threadCount; t++) {
+            for(const auto &match : matches[t]) {
+                result.offsets[match.first + 1]++;
+            }
+        }
+        for(std::size_t i = 1; i <= queryCount; i++) {
+            result.offsets[i] += result.offsets[i - 1];
+        }
+        result.items.resize(result.offsets[queryCount]);
+        for(unsigned t = 0; t < threadCount; t++) {
+            for(const auto &match : matches[t]) {
+                result.items[result.offsets[match.first]++] = match.second;
+            }
+        }
+
+        // Placing moved the start of each group to the start of the next one, so shift them back
+        for(std::size_t i = queryCount; i > 1; i--) {
+            result.offsets[i - 1] = result.offsets[i - 2];
+        }
+        result.offsets[0] = 0;
+    }
+
+    // Searches the QuadTree for elements that are fully contained within the given bound.
+    template <typename T>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryContain(const Bound &bound) const {
+        std::vector<Handle> foundItems;
+        queryContain(bound, foundItems);
+        return foundItems;                              
+    }
+
+    // Searches the QuadTree for elements that are fully contained within the given bound, appending them to the given container.
+    template <typename T>
+    void QuadTree<T>::queryContain(const Bound &bound, std::vector<Handle> &foundItems) const {
+        // Call the generic query method of the node class, but with the containFn predicate.          
+        rootNode->template query<true>(bound, foundItems, containFn, getPackedItems());
+    }
+
+    // Passes the elements that overlap with the given bound to the callback, one by one.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::forEachOverlap(const Bound &bound, Callback callback) const {
+        auto rangeFn = [&callback](const Handle *first, const Handle *last) {return invokeForEach(callback, first, last);};
+        return rootNode->template visit<true>(bound, overlapFn, rangeFn, getPackedItems());
+    }
+
+    // Passes the elements that are fully contained within the given bound to the callback, one by one.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::forEachContain(const Bound &bound, Callback callback) const {
+        auto rangeFn = [&callback](const Handle *first, const Handle *last) {return invokeForEach(callback, first, last);};
+        return rootNode->template visit<true>(bound, containFn, rangeFn, getPackedItems());
+    }
+
+    // Passes the elements that overlap with the given bound to the callback, in contiguous ranges.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::forEachOverlapRange(const Bound &bound, Callback callback) const {
+        auto rangeFn = [&callback](const Handle *first, const Handle *last) {return invokeCallback(callback, first, last);};
+        return rootNode->template visit<true>(bound, overlapFn, rangeFn, getPackedItems());
+    }
+
+    // Passes the elements that are fully contained within the given bound to the callback, in contiguous ranges.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::forEachContainRange(const Bound &bound, Callback callback) const {
+        auto rangeFn = [&callback](const Handle *first, const Handle *last) {return invokeCallback(callback, first, last);};
+        return rootNode->template visit<true>(bound, containFn, rangeFn, getPackedItems());
+    }
+
+    // Passes every pair of overlapping elements to the callback, each pair exactly once.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::forEachOverlappingPair(Callback callback) const {
+        typename QuadTreeNode::AncestorItems ancestors;
+        auto pairFn = [&callback](const Handle &a, const Handle &b) {return invokeCallback(callback, a, b);};
+        return rootNode->visitPairs(ancestors, 0, pairFn);
+    }
+
+    // Passes every pair of overlapping elements to the callback, each pair exactly once, on multiple threads.
+    template <typename T>
+    template <typename Callback>
+    void QuadTree<T>::forEachOverlappingPair(Callback callback, unsigned threadCount) const {
+        // The return value of the callback is dropped, a thread can't stop the others
+        auto pairFn = [&callback](const Handle &a, const Handle &b) {callback(a, b); return true;};
+        rootNode->parallelPairs(pairFn, threadCount);
+    }
+
+    // Passes every pair of overlapping elements of two QuadTrees to the callback, each pair exactly once.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::spatialJoin(const QuadTree<T> &treeA, const QuadTree<T> &treeB, Callback callback) {
+        auto pairFn = [&callback](const Handle &a, const Handle &b) {return invokeCallback(callback, a, b);};
+        return treeA.rootNode->join(*treeB.rootNode, pairFn);
+    }
+
+    // Searches the QuadTree for elements that contain the given point.
+    template <typename T>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryPoint(const Vec2D_i32 &point) const {
+        std::vector<Handle> foundItems;
+        queryPoint(point, foundItems);
+        return foundItems;
+    }
+
+    // Searches the QuadTree for elements that contain the given point, appending them to the given container.
+    template <typename T>
+    void QuadTree<T>::queryPoint(const Vec2D_i32 &point, std::vector<Handle> &foundItems) const {
+        rootNode->queryPoint(point, foundItems);
+    }
+
+    // Searches the QuadTree for elements that are within the given distance of a point.
+    template <typename T>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryRadius(const Vec2D_i32 &center, double radius) const {
+        std::vector<Handle> foundItems;
+        queryRadius(center, radius, foundItems);
+        return foundItems;
+    }
+
+    // Searches the QuadTree for elements that are within the given distance of a point, appending them to the given container.
+    template <typename T>
+    void QuadTree<T>::queryRadius(const Vec2D_i32 &center, double radius, std::vector<Handle> &foundItems) const {
+        auto collectFn = [&foundItems](const Handle &item, int64_t) {foundItems.push_back(item);};
+        if(radius >= 0) {
+            rootNode->visitRadius(center, radius * radius, collectFn);
+        }
+    }
+
+    // Searches the QuadTree for elements that are within the given distance of a point, together with their squared distances.
+    template <typename T>
+    void QuadTree<T>::queryRadius(const Vec2D_i32 &center, double radius, std::vector<Handle> &foundItems, std::vector<int64_t> &squaredDistances) const {
+        auto collectFn = [&](const Handle &item, int64_t squaredDistance) {
+            foundItems.push_back(item);
+            squaredDistances.push_back(squaredDistance);
+        };
+        if(radius >= 0) {
+            rootNode->visitRadius(center, radius * radius, collectFn);
+        }
+    }
+
+    // Searches the QuadTree for the elements that are nearest to the given point.
+    template <typename T>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryNearest(const Vec2D_i32 &point, std::size_t k, double maxDistance) const {
+        std::vector<Handle> foundItems;
+        if(k == 0 || maxDistance < 0) {
+            return foundItems;
+        }
+        // The search compares squared distances, which are exact
+        rootNode->nearest(point, k, maxDistance * maxDistance, foundItems);
+        return foundItems;
+    }
+
+    // Searches the QuadTree for elements that are fully contained within the given bound, on multiple threads.
+    template <typename T>
+    void QuadTree<T>::queryContain(const Bound &bound, std::vector<Handle> &foundItems, unsigned threadCount) const {
+        rootNode->template parallelQuery<true>(bound, foundItems, containFn, getPackedItems(), threadCount);
+    }
+
+    // Searches the QuadTree for elements that are hit by the given ray, in the order they are hit.
+    template <typename T>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryRay(const Vec2D_f64 &origin, const Vec2D_f64 &direction, double maxT) const {
+        std::vector<Handle> foundItems;
+        forEachRayHit(origin, direction, maxT, [&foundItems](const Handle &item, double) {foundItems.push_back(item);});
+        return foundItems;
+    }
+
+    // Passes the elements that are hit by the given ray to the callback, in the order they are hit.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::forEachRayHit(const Vec2D_f64 &origin, const Vec2D_f64 &direction, double maxT, Callback callback) const {
+        auto hitFn = [&callback](const Handle &item, double entry) {return invokeCallback(callback, item, entry);};
+        return rootNode->visitRay(origin, direction, maxT, hitFn);
+    }
+
+    // Searches the QuadTree for elements that overlap with the given region.
+    template <typename T>
+    template <typename Region>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryRegionOverlap(const Region &region) const {
+        std::vector<Handle> foundItems;
+        queryRegionOverlap(region, foundItems);
+        return foundItems;
+    }
+
+    // Searches the QuadTree for elements that overlap with the given region, appending them to the given container.
+    template <typename T>
+    template <typename Region>
+    void QuadTree<T>::queryRegionOverlap(const Region &region, std::vector<Handle> &foundItems) const {
+        auto collectFn = [&foundItems](const Handle *first, const Handle *last) {
+            foundItems.insert(foundItems.end(), first, last);
+            return true;
+        };
+        rootNode->template visitRegion<false>(region, collectFn, getPackedItems());
+    }
+
+    // Searches the QuadTree for elements that are fully contained within the given region.
+    template <typename T>
+    template <typename Region>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryRegionContain(const Region &region) const {
+        std::vector<Handle> foundItems;
+        queryRegionContain(region, foundItems);
+        return foundItems;
+    }
+
+    // Searches the QuadTree for elements that are fully contained within the given region, appending them to the given container.
+    template <typename T>
+    template <typename Region>
+    void QuadTree<T>::queryRegionContain(const Region &region, std::vector<Handle> &foundItems) const {
+        auto collectFn = [&foundItems](const Handle *first, const Handle *last) {
+            foundItems.insert(foundItems.end(), first, last);
+            return true;
+        };
+        rootNode->template visitRegion<true>(region, collectFn, getPackedItems());
+    }
+
+    // Searches the QuadTree for elements that overlap with the given bound, and satisfy a custom predicate.
+    template <typename T>
+    template <typename Predicate>
+    std::vector<typename QuadTree<T>::Handle> QuadTree<T>::queryIf(const Bound &bound, Predicate predicateFn) const {
+        std::vector<Handle> foundItems;
+        // The custom predicate may reject items of fully covered nodes too, so every item has to be tested.
+        rootNode->template query<false>(bound, foundItems, [&](const qt::Bound &a, const qt::Bound &b) {return a.overlaps(b) && predicateFn(b);}, nullptr);
+        return foundItems;
+    }
+
+    // Counts the elements of the QuadTree that overlap with the given bound.
+    template <typename T>
+    std::size_t QuadTree<T>::countOverlap(const Bound &bound) const {
+        return rootNode->template count<true>(bound, overlapFn);
+    }
+
+    // Counts the elements of the QuadTree that are fully contained within the given bound.
+    template <typename T>
+    std::size_t QuadTree<T>::countContain(const Bound &bound) const {
+        return rootNode->template count<true>(bound, containFn);
+    }
+
+    // Removes all elements from the QuadTree that overlap with the given bound.
+    template <typename T>
+    void QuadTree<T>::removeOverlap(const Bound &bound) {
+        QueryScratch scratch;
+        removeOverlap(bound, scratch);
+    }
+
+    // Removes all elements from the QuadTree that overlap with the given bound, using the given working memory.
+    template <typename T>
+    void QuadTree<T>::removeOverlap(const Bound &bound, QueryScratch &scratch) {
+        // We call the generic remove with the overlap predicate,
+        // and the removed items are erased from the container of the items.
+        rootNode->template remove<true>(bound, [this](const Handle &item) {items.erase(item);}, overlapFn, scratch, itemLocations);
+        packedValid = false;
+    }
+
+    // Removes all elements from the QuadTree that are contained within the given bound.
+    template <typename T>
+    void QuadTree<T>::removeContain(const Bound &bound) {
+        QueryScratch scratch;
+        removeContain(bound, scratch);
+    }
+
+    // Removes all elements from the QuadTree that are contained within the given bound, using the given working memory.
+    template <typename T>
+    void QuadTree<T>::removeContain(const Bound &bound, QueryScratch &scratch) {
+        // We call the generic remove with the contain predicate,
+        // and the removed items are erased from the container of the items.
+        rootNode->template remove<true>(bound, [this](const Handle &item) {items.erase(item);}, containFn, scratch, itemLocations);
+        packedValid = false;
+    }
+
+    // Removes all elements from the QuadTree that overlap with the given bound, on multiple threads.
+    template <typename T>
+    void QuadTree<T>::removeOverlap(const Bound &bound, unsigned threadCount) {
+        rootNode->template parallelRemove<true>(bound, &items, overlapFn, threadCount, itemLocations);
+        packedValid = false;
+    }
+
+    // Removes all elements from the QuadTree that are contained within the given bound, on multiple threads.
+    template <typename T>
+    void QuadTree<T>::removeContain(const Bound &bound, unsigned threadCount) {
+        rootNode->template parallelRemove<true>(bound, &items, containFn, threadCount, itemLocations);
+        packedValid = false;
+    }
+
+    // Removes all elements from the QuadTree that overlap with the given bound, and satisfy a custom predicate.
+    template <typename T>
+    template <typename Predicate>
+    void QuadTree<T>::removeIf(const Bound &bound, Predicate predicateFn) {
+        // The custom predicate may keep items of fully covered nodes too, so every item has to be tested.
+        QueryScratch scratch;
+        rootNode->template remove<false>(bound, [this](const Handle &item) {items.erase(item);},
+            [&](const qt::Bound &a, const qt::Bound &b) {return a.overlaps(b) && predicateFn(b);}, scratch, itemLocations);
+        packedValid = false;
+    }
+
+    // Lays out the handles of all the elements in spatial order, so that every subtree is a contiguous range.
+    template <typename T>
+    void QuadTree<T>::pack() {
+        // Nothing has changed since the last time
+        if(packedValid) {
+            return;
+        }
+
+        packedItems.clear();
+        packedItems.reserve(items.size());
+        rootNode->pack(packedItems);
+        packedValid = true;
+    }
+
+    // Decides whether the handles are laid out in spatial order, i.e. the tree hasn't changed since the last pack().
+    template <typename T>
+    bool QuadTree<T>::isPacked() const {
+        return packedValid;
+    }
+
+    // Returns all the boundaries that make up the QuadTree.
+    template <typename T>
+    std::vector<Bound> QuadTree<T>::getBounds() const {
+        std::vector<Bound> bounds;
+        rootNode->getBounds(bounds);
+        return bounds;
+    }
+
+    // Accesses the element identified by the given Handle.
+    template <typename T>
+    T& QuadTree<T>::operator[](const Handle &handle) {
+        return items[handle];
+    }
+
+    // Accesses the element identified by the given Handle.
+    template <typename T>
+    const T& QuadTree<T>::operator[](const Handle &handle) const {
+        return items[handle];
+    }
+
+    // Decides whether the given Handle still identifies an element of the QuadTree.
+    template <typename T>
+    bool QuadTree<T>::contains(const Handle &handle) const {
+        return items.contains(handle);
+    }
+
+    // Returns the number of elements stored in the QuadTree.
+    template <typename T>
+    std::size_t QuadTree<T>::size() const {
+        return items.size();
+    }
+
+    // Calls the visitor callback with the given arguments, and tells whether the traversal should continue.
+    template <typename T>
+    template <typename Callback, typename... Args>
+    bool QuadTree<T>::invokeCallback(Callback &callback, const Args&... args) {
+        // A callback returning nothing never stops the traversal
+        if constexpr (std::is_void<decltype(callback(args...))>::value) {
+            callback(args...);
+            return true;
+        } else {
+            return callback(args...);
+        }
+    }
+
+    // Calls the visitor callback with each element of a range, and tells whether the traversal should continue.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::invokeForEach(Callback &callback, const Handle *first, const Handle *last) {
+        for(; first != last; ++first) {
+            if(!invokeCallback(callback, *first)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns the spatially ordered handles, or nullptr if they are outdated.
+    template <typename T>
+    const typename QuadTree<T>::Handle* QuadTree<T>::getPackedItems() const {
+        return packedValid ? packedItems.data() : nullptr;
+    }
+
+    // Runs the given number of tasks on the given number of threads (including the calling one).
+    template <typename T>
+    template <typename Task>
+    void QuadTree<T>::runParallel(std::size_t taskCount, unsigned threadCount, Task taskFn) {
+        threadCount = getThreadCount(taskCount, threadCount);
+
+        // The threads take the next task until none is left
+        std::atomic<std::size_t> nextTask(0);
+        auto worker = [&](unsigned threadIndex) {
+            for(std::size_t task = nextTask++; task < taskCount; task = nextTask++) {
+                taskFn(task, threadIndex);
+            }
+        };
+
+        // The calling thread is the first worker
+        std::vector<std::thread> threads;
+        for(unsigned i = 1; i < threadCount; i++) {
+            threads.emplace_back(worker, i);
+        }
+        worker(0);
+        for(auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Returns the number of threads that should be used for the given number of tasks.
+    template <typename T>
+    unsigned QuadTree<T>::getThreadCount(std::size_t taskCount, unsigned threadCount) {
+        if(threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        // There is no use of more threads than tasks
+        return unsigned(std::max<std::size_t>(1, std::min<std::size_t>(threadCount, taskCount)));
+    }
+
+    // Calculates the Morton (Z-order) code of the center of a bound, on a 2^16 x 2^16 grid over the QuadTree.
+    template <typename T>
+    uint32_t QuadTree<T>::getMortonCode(const Bound &queryBound) const {
+        // The position of the center on the grid, clamped to the QuadTree
+        int64_t width = int64_t(bound.bottomRight.x) - bound.topLeft.x + 1, height = int64_t(bound.bottomRight.y) - bound.topLeft.y + 1;
+        int64_t x = (int64_t(queryBound.topLeft.x) + queryBound.bottomRight.x) / 2 - bound.topLeft.x;
+        int64_t y = (int64_t(queryBound.topLeft.y) + queryBound.bottomRight.y) / 2 - bound.topLeft.y;
+        x = x < 0 ? 0 : (x >= width ? width - 1 : x);
+        y = y < 0 ? 0 : (y >= height ? height - 1 : y);
+
+        // Spread the 16 bits of a coordinate to the even bits, so that the two coordinates can be interleaved
+        auto spreadBits = [](uint32_t v) {
+            v = (v | (v << 8)) & 0x00FF00FFu;
+            v = (v | (v << 4)) & 0x0F0F0F0Fu;
+            v = (v | (v << 2)) & 0x33333333u;
+            v = (v | (v << 1)) & 0x55555555u;
+            return v;
+        };
+        return spreadBits(uint32_t(x * 65536 / width)) | (spreadBits(uint32_t(y * 65536 / height)) << 1);
+    }
+
+    /*------------------------------------------------
+        QuadTree<T>::Batch struct implementation
+    --------------------------------------------------*/
+
+    // Collects the insertion of an element.
+    template <typename T>
+    void QuadTree<T>::Batch::insert(const T &itemWithBound) {
+        insertions.push_back(itemWithBound);
+    }
+
+    // Collects the insertion of an element, by moving it.
+    template <typename T>
+    void QuadTree<T>::Batch::insert(T &&itemWithBound) {
+        insertions.push_back(std::move(itemWithBound));
+    }
+
+    // Collects the insertion of an element, constructed in place from the given arguments.
+    template <typename T>
+    template <typename... Args>
+    void QuadTree<T>::Batch::emplace(Args&&... args) {
+        insertions.emplace_back(std::forward<Args>(args)...);
+    }
+
+    // Collects the replacement of an element.
+    template <typename T>
+    void QuadTree<T>::Batch::update(const Handle &handle, const T &itemWithBound) {
+        updates.emplace_back(handle, itemWithBound);
+    }
+
+    // Collects the replacement of an element, by moving the new value.
+    template <typename T>
+    void QuadTree<T>::Batch::update(const Handle &handle, T &&itemWithBound) {
+        updates.emplace_back(handle, std::move(itemWithBound));
+    }
+
+    // Collects the removal of an element.
+    template <typename T>
+    void QuadTree<T>::Batch::erase(const Handle &handle) {
+        erasures.push_back(handle);
+    }
+
+    // Returns the number of collected mutations.
+    template <typename T>
+    std::size_t QuadTree<T>::Batch::size() const {
+        return insertions.size() + updates.size() + erasures.size();
+    }
+
+    // Decides whether no mutations have been collected.
+    template <typename T>
+    bool QuadTree<T>::Batch::empty() const {
+        return size() == 0;
+    }
+
+    // Discards all the collected mutations.
+    template <typename T>
+    void QuadTree<T>::Batch::clear() {
+        insertions.clear();
+        updates.clear();
+        erasures.clear();
+    }
+
+    /*------------------------------------------------
+      QuadTree<T>::QuadTreeNode class implementation
+    --------------------------------------------------*/
+
+    // Constructs a QuadTreeNode.
+    template <typename T>
+    QuadTree<T>::QuadTreeNode::QuadTreeNode(const Bound &bound, int depth, QuadTreeNode* parent) : depth(depth), bound(bound), parent(parent) {
+        // The node is a leaf node if it can't be divided more, or if it has reached the maximal depth level
+        leafNode = !(bound.quadDivisible()) || depth + 1 == MAXDEPTH;
+
+        // If it isn't a leaf, get the bounds of its children
+        if(!leafNode) {
+            childrenBounds = bound.getQuadDivision();
+        }
+        
+        // No children and no items yet, and not packed yet
+        children = nullptr;
+        itemCount = 0;
+        packedBegin = packedEnd = 0;
+    }
+
+    // Destroys the node.
+    template <typename T>
+    QuadTree<T>::QuadTreeNode::~QuadTreeNode() {
+        // The children are not deleted here, they are owned by the arena of the QuadTree
+    }
+
+    // Inserts a handle to an element in the tree.
+    template <typename T>
+    typename QuadTree<T>::QuadTreeNode* QuadTree<T>::QuadTreeNode::insert(const Handle &item, const qt::Bound &itemBound, Arena<QuadTreeNode> &nodeArena,
+            std::vector<ItemLocation> &itemLocations) {
+        // Let's search the node in which the item should be inserted into,
+        // and let's start with "this" node (usually the root)
+        QuadTreeNode* currentNode = this;
+
+        // Keep track that have we inserted it already, or should we continue the search, and
+        // have we found the next node in the search path
+        bool inserted = false, foundNext;
+        while(!inserted) {
+            // The item ends up in the subtree of every node on the search path
+            currentNode->itemCount++;
+
+            // We haven't yet found a next node in the search path
+            foundNext = false;
+
+            // If the current node is not a leaf, we can check for its children
+            if(!currentNode->leafNode) {
+                // Iterate through its children
+                for(int i = 0; i < 4 && !foundNext; i++) {
+                    // If the current child should contain the bound of the item
+                    if(currentNode->childrenBounds[i].contains(itemBound)) {
+                        // Check if the children exist
+                        if(currentNode->children) {
+                            // if they exist, we have found the next node in the search path
+                            currentNode = &currentNode->children[i];
+                            foundNext = true;
+                        }
+                        // If they don't exist, but we can create them
+                        else if(currentNode->depth < MAXDEPTH - 1) {
+                            // Let's create all four siblings in one block of the arena,
+                            // and we also have our next node in the search path
+                            QuadTreeNode* block = nodeArena.allocate(4);
+                            for(int j = 0; j < 4; j++) {
+                                new (block + j) QuadTreeNode(currentNode->childrenBounds[j], currentNode->depth + 1, currentNode);
+                            }
+                            currentNode->children = block;
+                            currentNode = &currentNode->children[i];
+                            foundNext = true;
+                        }
+                    }
+                }
+            }
+            
+            // If we didn't succeed with any of the searches above, the item
+            // should be inserted in the current node's container
+            if(!foundNext) {
+                itemLocations[item.index] = {currentNode, uint32_t(currentNode->items.size())};
+                currentNode->items.push_back(item, itemBound);
+                inserted = true;
+            }
+        }
+        return currentNode;
+    }
+
+    // Relocates a handle stored in this node according to the new bound of its element.
+    template <typename T>
+    typename QuadTree<T>::QuadTreeNode* QuadTree<T>::QuadTreeNode::update(const Handle &item, const qt::Bound &itemBound, Arena<QuadTreeNode> &nodeArena,
+            std::vector<ItemLocation> &itemLocations) {
+        // If the element would stay in this node, there is no need to touch the other elements
+        if(updateInPlace(item, itemBound, itemLocations)) {
+            return this;
+        }
+
+        // Climb to the lowest node that contains the new bound (the root can store anything)
+        QuadTreeNode *ancestor = this;
+        while(ancestor->parent && !ancestor->bound.contains(itemBound)) {
+            ancestor = ancestor->parent;
+        }
+
+        // Then take it out of this node, and insert it from the ancestor (which counts it again)
+        erase(item, itemLocations);
+        for(QuadTreeNode *node = ancestor->parent; node; node = node->parent) {
+            node->itemCount++;
+        }
+        return ancestor->insert(item, itemBound, nodeArena, itemLocations);
+    }
+
+    // Overwrites the stored bound of a handle, if its element still belongs to this node with the new bound.
+    template <typename T>
+    bool QuadTree<T>::QuadTreeNode::updateInPlace(const Handle &item, const qt::Bound &itemBound, const std::vector<ItemLocation> &itemLocations) {
+        // The element has to be contained in this node (the root can store anything), and it would descend further,
+        // if one of the quadrons contains it, and the children exist or can be created
+        bool descends = false;
+        for(int i = 0; i < 4 && !leafNode && !descends; i++) {
+            descends = childrenBounds[i].contains(itemBound) && (children || depth < MAXDEPTH - 1);
+        }
+        if((parent && !bound.contains(itemBound)) || descends) {
+            return false;
+        }
+        items.setBound(itemLocations[item.index].position, itemBound);
+        return true;
+    }
+
+    // Calculates the locational code of the node (relative to this node) in which the element would be inserted.
+    template <typename T>
+    uint32_t QuadTree<T>::QuadTreeNode::getCellCode(const qt::Bound &itemBound) const {
+        // Follow the path of an insertion, but only with the coordinates of the nodes: of the quadrons that
+        // contain the element, the insertion takes the first one in NW, NE, SW, SE order.
+        // It is written without branches, as the sides that the elements fall on are unpredictable.
+        // The elements that are not (fully) inside of this node stay in it, just like at an insertion into the root.
+        if(!bound.contains(itemBound)) {
+            return 0;
+        }
+        int32_t left = bound.topLeft.x, top = bound.topLeft.y, right = bound.bottomRight.x, bottom = bound.bottomRight.y;
+        bool descending = true;
+        uint32_t code = 0;
+        for(int level = 0; level < MAXDEPTH - 1; level++) {
+            const int32_t centerX = left + (right - left) / 2, centerY = top + (bottom - top) / 2;
+            const bool inLeft = itemBound.bottomRight.x <= centerX, inRight = itemBound.topLeft.x >= centerX;
+            const bool inTop = itemBound.bottomRight.y <= centerY, inBottom = itemBound.topLeft.y >= centerY;
+            descending = descending & (left < right) & (top < bottom) & (inLeft | inRight) & (inTop | inBottom) & (depth + level + 1 < MAXDEPTH);
+
+            code = code * CELLCODEBASE + descending * (uint32_t(!inTop) * 2 + uint32_t(!inLeft) + 1);
+            right = (descending & inLeft) ? centerX : right;
+            left = (descending & !inLeft) ? centerX : left;
+            bottom = (descending & inTop) ? centerY : bottom;
+            top = (descending & !inTop) ? centerY : top;
+        }
+        return code;
+    }
+
+    // Loads the given elements in the subtree of this node at once.
+    template <typename T>
+    void QuadTree<T>::QuadTreeNode::build(const SlotMap<T> &itemContainer, const Handle *first, const Handle *last, Arena<QuadTreeNode> &nodeArena,
+            std::vector<ItemLocation> &itemLocations) {
+        // The codes have few enough values to be sorted by counting (a radix sort with a single digit)
+        std::vector<uint16_t> codes(last - first);
+        std::vector<uint32_t> counts(CELLCODECOUNT, 0);
+        for(std::size_t i = 0; i < codes.size(); i++) {
+            codes[i] = uint16_t(getCellCode(itemContainer[first[i]]));
+            counts[codes[i]]++;
+        }
+
+        // Create the nodes of the used codes in pre-order (so the nodes of a subtree are close to each other in the arena),
+        // and allocate the items of each node at once
+        std::vector<QuadTreeNode*> codeNodes(CELLCODECOUNT, nullptr);
+        for(uint32_t code = 0; code < CELLCODECOUNT; code++) {
+            if(counts[code] == 0) {
+                continue;
+            }
+
+            // Walk down to the node of the code, creating the missing children (all four siblings in one block of the arena)
+            QuadTreeNode *currentNode = this;
+            for(uint32_t divisor = CELLCODECOUNT / CELLCODEBASE; divisor > 0 && (code / divisor) % CELLCODEBASE != 0; divisor /= CELLCODEBASE) {
+                if(!currentNode->children) {
+                    QuadTreeNode* block = nodeArena.allocate(4);
+                    for(int j = 0; j < 4; j++) {
+                        new (block + j) QuadTreeNode(currentNode->childrenBounds[j], currentNode->depth + 1, currentNode);
+                    }
+                    currentNode->children = block;
+                }
+                currentNode = &currentNode->children[(code / divisor) % CELLCODEBASE - 1];
+            }
+
+            // (A node that already has items grows as usual, so that repeated loads don't reallocate it every time)
+            if(currentNode->items.empty()) {
+                currentNode->items.reserve(counts[code]);
+            }
+            for(QuadTreeNode *node = currentNode; node != parent; node = node->parent) {
+                node->itemCount += counts[code];
+            }
+            codeNodes[code] = currentNode;
+        }
+
+        // Finally distribute the elements, the items of the nodes are the buckets of the counting sort
+        for(std::size_t i = 0; i < codes.size(); i++) {
+            QuadTreeNode *node = codeNodes[codes[i]];
+            itemLocations[first[i].index] = {node, uint32_t(node->items.size())};
+            node->items.push_back(first[i], itemContainer[first[i]]);
+        }
+    }
+
+    // Removes a handle stored in this node, by moving the last handle of the node in its place.
+    template <typename T>
+    void QuadTree<T>::QuadTreeNode::erase(const Handle &item, std::vector<ItemLocation> &itemLocations) {
+        // The last handle takes the place of the removed one
+        const uint32_t position = itemLocations[item.index].position;
+        items.erase(position);
+        if(position < items.size()) {
+            itemLocations[items.handles[position].index].position = position;
+        }
+
+        // The removed element no longer counts in the node and its ancestors
+        for(QuadTreeNode *node = this; node; node = node->parent) {
+            node->itemCount--;
+        }
+    }
+
+    // Searches the tree for elements that overlap with/are contained in the given bound, based on the binary predicate function.
+    template <typename T>
+    template <bool wholeNodeMatch, typename Predicate>
+    void QuadTree<T>::QuadTreeNode::query(const qt::Bound &bound, std::vector<Handle> &foundItems, Predicate predicateFn, const Handle* packedItems) const {
+        // Stream the found ranges into the result container, a whole range at a time
+        auto collectFn = [&foundItems](const Handle *first, const Handle *last) {
+            foundItems.insert(foundItems.end(), first, last);
+            return true;
+        };
+        visit<wholeNodeMatch>(bound, predicateFn, collectFn, packedItems);
+    }
+
+    // Visits the elements of the tree that overlap with/are contained in the given bound, based on the binary predicate function.
+    template <typename T>
+    template <bool wholeNodeMatch, typename Predicate, typename RangeCallback>
+    bool QuadTree<T>::QuadTreeNode::visit(const qt::Bound &bound, Predicate predicateFn, RangeCallback &rangeCallback, const Handle* packedItems) const {
+        // The QuadTreeNodes that are still to be inspected, in a DFS order. A node is replaced by
+        // at most four children on the next level, so the stack can't outgrow its fixed size.
+        std::array<NodeVisit, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+
+        // Let's start the search with "this" node (usually the root)
+        nodeStack[stackSize++] = NodeVisit{this, false};
+        while(stackSize > 0) {
+            NodeVisit current = nodeStack[--stackSize];
+            const QuadTreeNode *currentNode = current.node;
+            const ItemBucket<Handle> &bucket = currentNode->items;
+
+            // If the node is fully contained within the bounds of the query (and the predicate is known to accept
+            // all of its items, which is decided at compile time), all of its and its children's items should be returned
+            bool allItems = current.allItems || (wholeNodeMatch && bound.contains(currentNode->bound));
+
+            // Except for the own items of the root: the elements outside of the tree bound are kept there, so they are always tested
+            if(allItems && currentNode != this) {
+                // If the handles are laid out in spatial order, the whole subtree is a single range, and we are done with it
+                if(packedItems) {
+                    if(currentNode->packedBegin != currentNode->packedEnd
+                        && !rangeCallback(packedItems + currentNode->packedBegin, packedItems + currentNode->packedEnd)) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                // Otherwise the items of the node are a range, and the children follow
+                if(!bucket.empty() && !rangeCallback(bucket.handles.data(), bucket.handles.data() + bucket.size())) {
+                    return false;
+                }
+            } else {
+                for(std::size_t i = 0; i < bucket.size(); i++) {
+                    // If the item overlaps/is within the query bound (checked using only the bounds stored
+                    // in the node, the items themselves are not touched), it should be passed to the callback
+                    if(predicateFn(bound, bucket.getBound(i)) && !rangeCallback(&bucket.handles[i], &bucket.handles[i] + 1)) {
+                        // The callback asked us to stop
+                        return false;
+                    }
+                }
+            }
+
+            // Let's check the children of the current node, if it has any (in reverse order, so that NW is visited first)
+            for(int i = 3; i >= 0 && currentNode->children; i--) {
+                // If the child has items, and its bound overlaps the query bound, we have to search it too
+                if(currentNode->children[i].itemCount > 0 && (allItems || bound.overlaps(currentNode->childrenBounds[i]))) {
+                    nodeStack[stackSize++] = NodeVisit{&currentNode->children[i], allItems};
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Visits the elements of the tree that overlap with/are contained in the given region.
+    template <typename T>
+    template <bool containItems, typename Region, typename RangeCallback>
+    bool QuadTree<T>::QuadTreeNode::visitRegion(const Region &region, RangeCallback &rangeCallback, const Handle* packedItems) const {
+        // The same fixed size DFS stack as in visit
+        std::array<NodeVisit, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+
+        // Let's start the search with "this" node (usually the root), unless it is outside of the region.
+        // The root also stores the elements that are outside of its bound, so it is always searched,
+        // and its own items are always classified one by one (its children are classified as usual).
+        RegionRelation relation = region.classify(bound);
+        if(!parent || relation != RegionRelation::OUTSIDE) {
+            nodeStack[stackSize++] = NodeVisit{this, parent && relation == RegionRelation::INSIDE};
+        }
+        while(stackSize > 0) {
+            NodeVisit current = nodeStack[--stackSize];
+            const QuadTreeNode *currentNode = current.node;
+            const ItemBucket<Handle> &bucket = currentNode->items;
+
+            if(current.allItems) {
+                // The node is inside the region, so its whole subtree is a single range if the handles are packed
+                if(packedItems) {
+                    if(currentNode->packedBegin != currentNode->packedEnd
+                        && !rangeCallback(packedItems + currentNode->packedBegin, packedItems + currentNode->packedEnd)) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                // Otherwise the items of the node are a range, and the children follow
+                if(!bucket.empty() && !rangeCallback(bucket.handles.data(), bucket.handles.data() + bucket.size())) {
+                    return false;
+                }
+            } else {
+                // The node is partially covered, so its items have to be classified one by one
+                for(std::size_t i = 0; i < bucket.size(); i++) {
+                    RegionRelation itemRelation = region.classify(bucket.getBound(i));
+                    bool found = containItems ? itemRelation == RegionRelation::INSIDE : itemRelation != RegionRelation::OUTSIDE;
+                    if(found && !rangeCallback(&bucket.handles[i], &bucket.handles[i] + 1)) {
+                        return false;
+                    }
+                }
+            }
+
+            // Let's classify the non-empty children of the current node, the ones outside of the region are skipped
+            for(int i = 3; i >= 0 && currentNode->children; i--) {
+                if(currentNode->children[i].itemCount == 0) {
+                    continue;
+                }
+                RegionRelation childRelation = current.allItems ? RegionRelation::INSIDE : region.classify(currentNode->childrenBounds[i]);
+                if(childRelation != RegionRelation::OUTSIDE) {
+                    nodeStack[stackSize++] = NodeVisit{&currentNode->children[i], childRelation == RegionRelation::INSIDE};
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Searches the tree for elements that overlap with a group of bounds, in a single traversal.
+    template <typename T>
+    void QuadTree<T>::QuadTreeNode::queryBatch(const Bound *queries, const uint32_t *queryIndices, int queryCount,
+        std::vector<std::pair<uint32_t, Handle>> &matches, const Handle* packedItems) const {
+        // The same fixed size DFS stack as in visit, but every entry carries the queries that still have to search the node
+        std::array<BatchVisit, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+
+        // Let's start the search with "this" node (usually the root), with the queries that overlap it
+        // (the root gets every query, as it also stores the elements that are outside of its bound)
+        uint64_t rootMask = 0;
+        for(int q = 0; q < queryCount; q++) {
+            if(!parent || queries[q].overlaps(bound)) {
+                rootMask |= uint64_t(1) << q;
+            }
+        }
+        if(rootMask) {
+            nodeStack[stackSize++] = BatchVisit{this, rootMask, 0};
+        }
+        while(stackSize > 0) {
+            BatchVisit current = nodeStack[--stackSize];
+            const QuadTreeNode *currentNode = current.node;
+            const ItemBucket<Handle> &bucket = currentNode->items;
+            uint64_t partialMask = current.partialMask, allMask = current.allMask;
+
+            // The queries that fully contain the node take all the items of its subtree.
+            // Not the root though: the elements outside of the tree bound are kept in it.
+            for(int q = 0; q < queryCount && currentNode != this; q++) {
+                uint64_t queryBit = uint64_t(1) << q;
+                if((partialMask & queryBit) && queries[q].contains(currentNode->bound)) {
+                    partialMask &= ~queryBit;
+                    allMask |= queryBit;
+                }
+            }
+
+            // They get the whole subtree at once if the handles are packed, otherwise the items of the node only
+            for(int q = 0; q < queryCount && allMask; q++) {
+                if(!(allMask & (uint64_t(1) << q))) {
+                    continue;
+                }
+                const Handle *first = packedItems ? packedItems + currentNode->packedBegin : bucket.handles.data();
+                const Handle *last = packedItems ? packedItems + currentNode->packedEnd : bucket.handles.data() + bucket.size();
+                for(; first != last; ++first) {
+                    matches.push_back(std::make_pair(queryIndices[q], *first));
+                }
+            }
+            if(packedItems) {
+                allMask = 0;
+            }
+
+            // The items of the node are loaded once, and tested against every query that partially covers the node
+            for(std::size_t i = 0; i < bucket.size() && partialMask; i++) {
+                const Bound itemBound = bucket.getBound(i);
+                for(int q = 0; q < queryCount; q++) {
+                    if((partialMask & (uint64_t(1) << q)) && queries[q].overlaps(itemBound)) {
+                        matches.push_back(std::make_pair(queryIndices[q], bucket.handles[i]));
+                    }
+                }
+            }
+
+            // Let's check the non-empty children, with the queries that overlap them
+            for(int i = 3; i >= 0 && currentNode->children; i--) {
+                if(currentNode->children[i].itemCount == 0) {
+                    continue;
+                }
+                uint64_t childMask = 0;
+                for(int q = 0; q < queryCount; q++) {
+                    if((partialMask & (uint64_t(1) << q)) && queries[q].overlaps(currentNode->childrenBounds[i])) {
+                        childMask |= uint64_t(1) << q;
+                    }
+                }
+                if(childMask || allMask) {
+                    nodeStack[stackSize++] = BatchVisit{&currentNode->children[i], childMask, allMask};
+                }
+            }
+        }
+    }
+
+    // Counts the elements of the tree that overlap with/are contained in the given bound.
+    template <typename T>
+    template <bool wholeNodeMatch, typename Predicate>
+    std::size_t QuadTree<T>::QuadTreeNode::count(const qt::Bound &bound, Predicate predicateFn) const {
+        // The same fixed size DFS stack as in visit, but a fully covered subtree is never descended into
+        std::array<const QuadTreeNode*, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+        std::size_t foundCount = 0;
+
+        // Let's start the search with "this" node (usually the root)
+        nodeStack[stackSize++] = this;
+        while(stackSize > 0) {
+            const QuadTreeNode *currentNode = nodeStack[--stackSize];
+
+            // If the node is fully contained within the bounds of the query, all the items of its subtree are found.
+            // Not for the root though, the elements outside of the tree bound are kept in it.
+            if(wholeNodeMatch && currentNode != this && bound.contains(currentNode->bound)) {
+                foundCount += currentNode->itemCount;
+                continue;
+            }
+
+            // Otherwise the items of the node have to be tested one by one
+            const ItemBucket<Handle> &bucket = currentNode->items;
+            for(std::size_t i = 0; i < bucket.size(); i++) {
+                if(predicateFn(bound, bucket.getBound(i))) {
+                    foundCount++;
+                }
+            }
+
+            // Let's check the non-empty children of the current node that overlap the query bound
+            for(int i = 3; i >= 0 && currentNode->children; i--) {
+                if(currentNode->children[i].itemCount > 0 && bound.overlaps(currentNode->childrenBounds[i])) {
+                    nodeStack[stackSize++] = &currentNode->children[i];
+                }
+            }
+        }
+
+        return foundCount;
+    }
+
+    // Visits the elements of the tree that are hit by the given ray, in the order they are hit.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::QuadTreeNode::visitRay(const Vec2D_f64 &origin, const Vec2D_f64 &direction, double maxT, Callback &callback) const {
+        // The nodes and the elements that the ray hits, the one that is entered first on the top
+        std::priority_queue<BestFirstVisit<double>> rayQueue;
+
+        // Let's start the search with "this" node (usually the root), if the ray reaches it at all. The root also stores
+        // the elements that are outside of its bound, so it is always searched (from the start of the ray).
+        double entry = 0;
+        if(!parent || bound.intersectsRay(origin, direction, maxT, entry)) {
+            rayQueue.push(BestFirstVisit<double>{entry, this, Handle{}});
+        }
+        while(!rayQueue.empty()) {
+            BestFirstVisit<double> current = rayQueue.top();
+            rayQueue.pop();
+
+            // If an element is on the top, nothing that is still in the queue is hit earlier
+            if(!current.node) {
+                if(!callback(current.item, current.key)) {
+                    return false;
+                }
+                continue;
+            }
+
+            // Otherwise it is a node, so let's queue its elements that are hit (using the bounds stored in the node)
+            const QuadTreeNode *currentNode = current.node;
+            const ItemBucket<Handle> &bucket = currentNode->items;
+            for(std::size_t i = 0; i < bucket.size(); i++) {
+                if(bucket.getBound(i).intersectsRay(origin, direction, maxT, entry)) {
+                    rayQueue.push(BestFirstVisit<double>{entry, nullptr, bucket.handles[i]});
+                }
+            }
+
+            // And its non-empty children that the ray crosses, in the order the ray enters them
+            for(int i = 0; i < 4 && currentNode->children; i++) {
+                if(currentNode->children[i].itemCount > 0 && currentNode->childrenBounds[i].intersectsRay(origin, direction, maxT, entry)) {
+                    rayQueue.push(BestFirstVisit<double>{entry, &currentNode->children[i], Handle{}});
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Visits the elements of the tree that are within the given squared distance of a point.
+    template <typename T>
+    template <typename Callback>
+    void QuadTree<T>::QuadTreeNode::visitRadius(const Vec2D_i32 &center, double maxSquaredDistance, Callback &callback) const {
+        // The same fixed size DFS stack as in visit
+        std::array<const QuadTreeNode*, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+
+        // Let's start the search with "this" node (usually the root), if the circle reaches it at all
+        // (the root is always searched, as it also stores the elements that are outside of its bound)
+        if(!parent || bound.squaredDistance(center) <= maxSquaredDistance) {
+            nodeStack[stackSize++] = this;
+        }
+        while(stackSize > 0) {
+            const QuadTreeNode *currentNode = nodeStack[--stackSize];
+
+            // Check the exact distance of each item (using the bounds stored in the node)
+            const ItemBucket<Handle> &bucket = currentNode->items;
+            for(std::size_t i = 0; i < bucket.size(); i++) {
+                int64_t squaredDistance = bucket.getBound(i).squaredDistance(center);
+                if(squaredDistance <= maxSquaredDistance) {
+                    callback(bucket.handles[i], squaredDistance);
+                }
+            }
+
+            // Only the non-empty children that the circle reaches have to be searched, which leaves out
+            // the children that overlap only with the corners of the bounding square of the circle
+            for(int i = 3; i >= 0 && currentNode->children; i--) {
+                if(currentNode->children[i].itemCount > 0 && currentNode->childrenBounds[i].squaredDistance(center) <= maxSquaredDistance) {
+                    nodeStack[stackSize++] = &currentNode->children[i];
+                }
+            }
+        }
+    }
+
+    // Searches the tree for elements that contain the given point, descending only the nodes that contain it.
+    template <typename T>
+    void QuadTree<T>::QuadTreeNode::queryPoint(const Vec2D_i32 &point, std::vector<Handle> &foundItems) const {
+        // Usually a single path, but a point on a dividing line continues in every child on that line,
+        // and every node is replaced by at most four children, so the fixed size stack is enough
+        std::array<const QuadTreeNode*, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+
+        // Let's start the search with "this" node (usually the root)
+        nodeStack[stackSize++] = this;
+        while(stackSize > 0) {
+            const QuadTreeNode *currentNode = nodeStack[--stackSize];
+
+            // Check the items of the node against the point, reading only the coordinate arrays of the bucket
+            const ItemBucket<Handle> &bucket = currentNode->items;
+            for(std::size_t i = 0; i < bucket.size(); i++) {
+                if(bucket.minX[i] <= point.x && point.x <= bucket.maxX[i] && bucket.minY[i] <= point.y && point.y <= bucket.maxY[i]) {
+                    foundItems.push_back(bucket.handles[i]);
+                }
+            }
+
+            // A point outside of the node can only be contained by the elements of the root that are outside of its bound
+            if(!currentNode->children || !currentNode->bound.contains(qt::Bound(point, point))) {
+                continue;
+            }
+
+            // The children share the dividing lines (the bottom right corner of the NW child), so the point is in
+            // the western/northern children if it is not past them, and in the eastern/southern ones if it is not before them
+            const Vec2D_i32 &middle = currentNode->childrenBounds[0].bottomRight;
+            bool west = point.x <= middle.x, east = point.x >= middle.x;
+            bool north = point.y <= middle.y, south = point.y >= middle.y;
+            const bool inChild[4] = {north && west, north && east, south && west, south && east};
+            for(int i = 3; i >= 0; i--) {
+                if(inChild[i] && currentNode->children[i].itemCount > 0) {
+                    nodeStack[stackSize++] = &currentNode->children[i];
+                }
+            }
+        }
+    }
+
+    // Searches the tree for the elements that are nearest to the given point, in a best-first order.
+    template <typename T>
+    void QuadTree<T>::QuadTreeNode::nearest(const Vec2D_i32 &point, std::size_t k, double maxSquaredDistance, std::vector<Handle> &foundItems) const {
+        // The nodes and the elements that are still to be inspected, the nearest one on the top
+        std::priority_queue<BestFirstVisit<int64_t>> nearestQueue;
+        std::size_t foundCount = 0;
+
+        // Let's start the search with "this" node (usually the root). The root also stores the elements that are
+        // outside of its bound, so the distance of its bound is no lower bound for them.
+        nearestQueue.push(BestFirstVisit<int64_t>{parent ? bound.squaredDistance(point) : 0, this, Handle{}});
+        while(!nearestQueue.empty() && foundCount < k) {
+            BestFirstVisit<int64_t> current = nearestQueue.top();
+            nearestQueue.pop();
+
+            // Everything else in the queue is at least this far, so none of them can be found
+            if(current.key > maxSquaredDistance) {
+                break;
+            }
+
+            // If an element is on the top, nothing that is still in the queue can be nearer to the point
+            if(!current.node) {
+                foundItems.push_back(current.item);
+                foundCount++;
+                continue;
+            }
+
+            // Otherwise it is a node, so let's queue its elements (using the bounds stored in the node)
+            const QuadTreeNode *currentNode = current.node;
+            const ItemBucket<Handle> &bucket = currentNode->items;
+            for(std::size_t i = 0; i < bucket.size(); i++) {
+                int64_t squaredDistance = bucket.getBound(i).squaredDistance(point);
+                if(squaredDistance <= maxSquaredDistance) {
+                    nearestQueue.push(BestFirstVisit<int64_t>{squaredDistance, nullptr, bucket.handles[i]});
+                }
+            }
+
+            // And its non-empty children, which are visited only if they can still contain a nearer element
+            for(int i = 0; i < 4 && currentNode->children; i++) {
+                int64_t squaredDistance = currentNode->childrenBounds[i].squaredDistance(point);
+                if(currentNode->children[i].itemCount > 0 && squaredDistance <= maxSquaredDistance) {
+                    nearestQueue.push(BestFirstVisit<int64_t>{squaredDistance, &currentNode->children[i], Handle{}});
+                }
+            }
+        }
+    }
+
+    // Orders the entries of a best-first search for a min-heap.
+    template <typename T>
+    template <typename Key>
+    bool QuadTree<T>::QuadTreeNode::BestFirstVisit<Key>::operator<(const BestFirstVisit &other) const {
+        // The farther entry has lower priority, and of the same distance, a node has lower priority than an element
+        return key > other.key || (key == other.key && node && !other.node);
+    }
+
+    // Visits the pairs of overlapping elements in which one element is stored in the node itself.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::QuadTreeNode::visitNodePairs(AncestorItems &ancestors, std::size_t ancestorBegin, Callback &callback) const {
+        // Only the elements of the ancestors that overlap with the node can overlap with the elements of its subtree
+        const std::size_t ancestorEnd = ancestors.size();
+        for(std::size_t i = ancestorBegin; i < ancestorEnd; i++) {
+            if(ancestors[i].second.overlaps(bound)) {
+                ancestors.push_back(ancestors[i]);
+            }
+        }
+
+        // Test every element of the node against the overlapping ancestors, and against the elements of the node before it
+        const std::size_t nodeBegin = ancestors.size();
+        for(std::size_t i = 0; i < items.size(); i++) {
+            const qt::Bound itemBound = items.getBound(i);
+            for(std::size_t j = ancestorEnd; j < ancestors.size(); j++) {
+                if(itemBound.overlaps(ancestors[j].second) && !callback(ancestors[j].first, items.handles[i])) {
+                    ancestors.erase(ancestors.begin() + ancestorEnd, ancestors.end());
+                    return false;
+                }
+            }
+            ancestors.emplace_back(items.handles[i], itemBound);
+        }
+
+        // The elements of the node are tested once more only if the node has children, they are not needed otherwise
+        if(!children) {
+            ancestors.erase(ancestors.begin() + nodeBegin, ancestors.end());
+            return true;
+        }
+
+        // The quadrons share their edges, so the elements of two different children can still touch on the dividing lines,
+        // collect those that touch them at the end of the container, grouped by the children
+        const Vec2D_i32 center = childrenBounds[0].bottomRight;
+        const qt::Bound verticalLine(Vec2D_i32(center.x, bound.topLeft.y), Vec2D_i32(center.x, bound.bottomRight.y));
+        const qt::Bound horizontalLine(Vec2D_i32(bound.topLeft.x, center.y), Vec2D_i32(bound.bottomRight.x, center.y));
+        const std::size_t edgeBegin = ancestors.size();
+        std::array<std::size_t, 5> childBegin;
+        for(int c = 0; c < 4; c++) {
+            childBegin[c] = ancestors.size();
+            if(children[c].itemCount > 0) {
+                children[c].collectEdgeItems(verticalLine, horizontalLine, ancestors);
+            }
+        }
+        childBegin[4] = ancestors.size();
+
+        // And test them against the collected elements of the preceding children
+        bool proceed = true;
+        for(int c = 1; c < 4 && proceed; c++) {
+            for(std::size_t i = childBegin[c]; i < childBegin[c + 1] && proceed; i++) {
+                for(std::size_t j = edgeBegin; j < childBegin[c] && proceed; j++) {
+                    if(ancestors[i].second.overlaps(ancestors[j].second)) {
+                        proceed = callback(ancestors[j].first, ancestors[i].first);
+                    }
+                }
+            }
+        }
+
+        ancestors.erase(ancestors.begin() + (proceed ? edgeBegin : ancestorEnd), ancestors.end());
+        return proceed;
+    }
+
+    // Appends the elements of the subtree that overlap with either of the two lines to the container.
+    template <typename T>
+    void QuadTree<T>::QuadTreeNode::collectEdgeItems(const qt::Bound &verticalLine, const qt::Bound &horizontalLine, AncestorItems &edgeItems) const {
+        std::array<const QuadTreeNode*, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+        nodeStack[stackSize++] = this;
+        while(stackSize > 0) {
+            const QuadTreeNode *currentNode = nodeStack[--stackSize];
+            const ItemBucket<Handle> &bucket = currentNode->items;
+            for(std::size_t i = 0; i < bucket.size(); i++) {
+                const qt::Bound itemBound = bucket.getBound(i);
+                if(itemBound.overlaps(verticalLine) || itemBound.overlaps(horizontalLine)) {
+                    edgeItems.emplace_back(bucket.handles[i], itemBound);
+                }
+            }
+
+            for(int i = 0; i < 4 && currentNode->children; i++) {
+                const qt::Bound &childBound = currentNode->childrenBounds[i];
+                if(currentNode->children[i].itemCount > 0 && (childBound.overlaps(verticalLine) || childBound.overlaps(horizontalLine))) {
+                    nodeStack[stackSize++] = &currentNode->children[i];
+                }
+            }
+        }
+    }
+
+    // Visits the pairs of overlapping elements in which at least one element is stored in the subtree of the node.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::QuadTreeNode::visitPairs(AncestorItems &ancestors, std::size_t ancestorBegin, Callback &callback) const {
+        // The recursion is bounded by MAXDEPTH, the container of the ancestors works as its stack
+        const std::size_t ancestorEnd = ancestors.size();
+        bool proceed = visitNodePairs(ancestors, ancestorBegin, callback);
+        for(int i = 0; i < 4 && children && proceed; i++) {
+            if(children[i].itemCount > 0) {
+                proceed = children[i].visitPairs(ancestors, ancestorEnd, callback);
+            }
+        }
+
+        if(ancestors.size() > ancestorEnd) {
+            ancestors.erase(ancestors.begin() + ancestorEnd, ancestors.end());
+        }
+        return proceed;
+    }
+
+    // Visits the pairs of overlapping elements of the tree, processing the large subtrees in parallel.
+    template <typename T>
+    template <typename Callback>
+    void QuadTree<T>::QuadTreeNode::parallelPairs(Callback &callback, unsigned threadCount) const {
+        // Split the top levels into subtrees on the calling thread, the same way as in parallelQuery,
+        // and every subtree gets its own copy of the elements of its ancestors
+        std::vector<std::pair<const QuadTreeNode*, AncestorItems>> tasks, pendingNodes;
+        pendingNodes.emplace_back(this, AncestorItems());
+        while(!pendingNodes.empty()) {
+            std::pair<const QuadTreeNode*, AncestorItems> current = std::move(pendingNodes.back());
+            pendingNodes.pop_back();
+            const QuadTreeNode *currentNode = current.first;
+            if(currentNode->itemCount < PARALLELTHRESHOLD || !currentNode->children || currentNode->depth >= FORKDEPTH) {
+                tasks.push_back(std::move(current));
+                continue;
+            }
+
+            // The pairs of the split node are visited right away, the rest of the container are the ancestors of the children
+            AncestorItems &ancestors = current.second;
+            const std::size_t ancestorEnd = ancestors.size();
+            currentNode->visitNodePairs(ancestors, 0, callback);
+            for(int i = 3; i >= 0; i--) {
+                if(currentNode->children[i].itemCount > 0) {
+                    pendingNodes.emplace_back(&currentNode->children[i], AncestorItems(ancestors.begin() + ancestorEnd, ancestors.end()));
+                }
+            }
+        }
+
+        // Every task uses its own container of the ancestors
+        runParallel(tasks.size(), threadCount, [&](std::size_t task, unsigned) {
+            tasks[task].first->visitPairs(tasks[task].second, 0, callback);
+        });
+    }
+
+    // Visits the pairs of overlapping elements, in which one element is one of the given candidates, and the other one is in the subtree.
+    template <typename T>
+    template <bool swapped, typename Callback>
+    bool QuadTree<T>::QuadTreeNode::visitCandidates(AncestorItems &candidates, std::size_t candidateBegin, Callback &callback) const {
+        // Only the candidates that overlap with the node can overlap with the elements of its subtree
+        // (except for the root, as it also stores the elements that are outside of its bound)
+        const std::size_t candidateEnd = candidates.size();
+        for(std::size_t i = candidateBegin; i < candidateEnd; i++) {
+            if(!parent || candidates[i].second.overlaps(bound)) {
+                candidates.push_back(candidates[i]);
+            }
+        }
+
+        // The recursion is bounded by MAXDEPTH, the container of the candidates works as its stack
+        bool proceed = true;
+        for(std::size_t i = 0; i < items.size() && candidates.size() > candidateEnd && proceed; i++) {
+            const qt::Bound itemBound = items.getBound(i);
+            for(std::size_t j = candidateEnd; j < candidates.size() && proceed; j++) {
+                if(itemBound.overlaps(candidates[j].second)) {
+                    proceed = swapped ? callback(items.handles[i], candidates[j].first) : callback(candidates[j].first, items.handles[i]);
+                }
+            }
+        }
+        for(int i = 0; i < 4 && children && candidates.size() > candidateEnd && proceed; i++) {
+            if(children[i].itemCount > 0) {
+                proceed = children[i].template visitCandidates<swapped>(candidates, candidateEnd, callback);
+            }
+        }
+
+        candidates.erase(candidates.begin() + candidateEnd, candidates.end());
+        return proceed;
+    }
+
+    // Visits the pairs of overlapping elements, in which one element is in the subtree of this node, and the other one is in the subtree of the other node.
+    template <typename T>
+    template <typename Callback>
+    bool QuadTree<T>::QuadTreeNode::join(const QuadTreeNode &other, Callback &callback) const {
+        // The pairs of subtrees that still need to be joined, their number is not bounded by the depth
+        // The bounds of the nodes prune the pairs, except for the roots, as they also store the elements that are outside of their bounds
+        std::vector<std::pair<const QuadTreeNode*, const QuadTreeNode*>> nodePairs;
+        AncestorItems candidates;
+        if(itemCount > 0 && other.itemCount > 0 && (!parent || !other.parent || bound.overlaps(other.bound))) {
+            nodePairs.emplace_back(this, &other);
+        }
+
+        bool proceed = true;
+        while(!nodePairs.empty() && proceed) {
+            const QuadTreeNode *nodeA = nodePairs.back().first, *nodeB = nodePairs.back().second;
+            nodePairs.pop_back();
+
+            // Split the larger node (if it can be split), so that the two sides descend at the same pace
+            const int64_t extentA = int64_t(nodeA->bound.bottomRight.x) - nodeA->bound.topLeft.x + nodeA->bound.bottomRight.y - nodeA->bound.topLeft.y;
+            const int64_t extentB = int64_t(nodeB->bound.bottomRight.x) - nodeB->bound.topLeft.x + nodeB->bound.bottomRight.y - nodeB->bound.topLeft.y;
+            const bool splitA = nodeA->children && (!nodeB->children || extentA >= extentB);
+            const QuadTreeNode *splitNode = splitA ? nodeA : nodeB, *otherNode = splitA ? nodeB : nodeA;
+
+            // The elements of the split node are joined with the whole subtree of the other node
+            for(std::size_t i = 0; i < splitNode->items.size(); i++) {
+                const qt::Bound itemBound = splitNode->items.getBound(i);
+                if(!otherNode->parent || itemBound.overlaps(otherNode->bound)) {
+                    candidates.emplace_back(splitNode->items.handles[i], itemBound);
+                }
+            }
+            if(!candidates.empty()) {
+                proceed = splitA ? nodeB->template visitCandidates<false>(candidates, 0, callback) : nodeA->template visitCandidates<true>(candidates, 0, callback);
+                candidates.clear();
+            }
+
+            // And the subtrees of its children with the subtree of the other node
+            for(int i = 3; i >= 0 && splitNode->children; i--) {
+                const QuadTreeNode &child = splitNode->children[i];
+                if(child.itemCount > 0 && (!otherNode->parent || child.bound.overlaps(otherNode->bound))) {
+                    nodePairs.emplace_back(splitA ? &child : nodeA, splitA ? nodeB : &child);
+                }
+            }
+        }
+        return proceed;
+    }
+
+    // Searches the tree for elements that overlap with/are contained in the given bound, processing the large subtrees in parallel.
+    template <typename T>
+    template <bool wholeNodeMatch, typename Predicate>
+    void QuadTree<T>::QuadTreeNode::parallelQuery(const qt::Bound &bound, std::vector<Handle> &foundItems, Predicate predicateFn, const Handle* packedItems, unsigned threadCount) const {
+        // Split the top levels into subtrees on the calling thread: a node with enough items is replaced by its children,
+        // the items of the node itself are searched right away, and the remaining subtrees become the tasks
+        // (the root is always searched, as it also stores the elements that are outside of its bound)
+        std::vector<const QuadTreeNode*> taskNodes;
+        std::array<const QuadTreeNode*, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+        if(!parent || bound.overlaps(this->bound)) {
+            nodeStack[stackSize++] = this;
+        }
+        while(stackSize > 0) {
+            // A fully covered subtree matches as a whole, but not the root: the elements outside of the tree bound are kept in it
+            const QuadTreeNode *currentNode = nodeStack[--stackSize];
+            bool allItems = wholeNodeMatch && currentNode != this && bound.contains(currentNode->bound);
+
+            // A fully covered subtree is a single range if the handles are packed, there is nothing to split
+            if(allItems && packedItems) {
+                foundItems.insert(foundItems.end(), packedItems + currentNode->packedBegin, packedItems + currentNode->packedEnd);
+                continue;
+            }
+            if(allItems || currentNode->itemCount < PARALLELTHRESHOLD || !currentNode->children || currentNode->depth >= FORKDEPTH) {
+                taskNodes.push_back(currentNode);
+                continue;
+            }
+
+            const ItemBucket<Handle> &bucket = currentNode->items;
+            for(std::size_t i = 0; i < bucket.size(); i++) {
+                if(predicateFn(bound, bucket.getBound(i))) {
+                    foundItems.push_back(bucket.handles[i]);
+                }
+            }
+            for(int i = 3; i >= 0; i--) {
+                if(currentNode->children[i].itemCount > 0 && bound.overlaps(currentNode->childrenBounds[i])) {
+                    nodeStack[stackSize++] = &currentNode->children[i];
+                }
+            }
+        }
+
+        // Search the subtrees in parallel, every task into its own buffer, then append the buffers in order
+        std::vector<std::vector<Handle>> taskItems(taskNodes.size());
+        runParallel(taskNodes.size(), threadCount, [&](std::size_t task, unsigned) {
+            taskNodes[task]->template query<wholeNodeMatch>(bound, taskItems[task], predicateFn, packedItems);
+        });
+
+        std::size_t totalCount = foundItems.size();
+        for(const auto &items : taskItems) {
+            totalCount += items.size();
+        }
+        foundItems.reserve(totalCount);
+        for(const auto &items : taskItems) {
+            foundItems.insert(foundItems.end(), items.begin(), items.end());
+        }
+    }
+
+    // Removes the elements from the tree that overlap with/are contained in the given bound, processing the large subtrees in parallel.
+    template <typename T>
+    template <bool wholeNodeMatch, typename Predicate>
+    void QuadTree<T>::QuadTreeNode::parallelRemove(const qt::Bound &bound, SlotMap<T>* itemContainer, Predicate predicateFn, unsigned threadCount,
+            std::vector<ItemLocation> &itemLocations) {
+        // Split the top levels into subtrees on the calling thread, the same way as in parallelQuery
+        std::vector<QuadTreeNode*> taskNodes;
+        std::array<QuadTreeNode*, MAXSTACKSIZE> nodeStack;
+        int stackSize = 0;
+        if(!parent || bound.overlaps(this->bound)) {
+            nodeStack[stackSize++] = this;
+        }
+        while(stackSize > 0) {
+            QuadTreeNode *currentNode = nodeStack[--stackSize];
+            if((wholeNodeMatch && bound.contains(currentNode->bound)) || currentNode->itemCount < PARALLELTHRESHOLD
+                || !currentNode->children || currentNode->depth >= FORKDEPTH) {
+                taskNodes.push_back(currentNode);
+                continue;
+            }
+
+            // The items of a split node are removed right away, while no task is running yet
+            std::size_t removedCount = currentNode->items.size();
+            currentNode->items.removeIf(
+                [&](const qt::Bound &itemBound) {return predicateFn(bound, itemBound);},
+                [&](const Handle &item) {itemContainer->erase(item);},
+                [&](const Handle &item, std::size_t position) {itemLocations[item.index].position = uint32_t(position);}
+            );
+            removedCount -= currentNode->items.size();
+            for(QuadTreeNode *ancestor = currentNode; ancestor; ancestor = ancestor->parent) {
+                ancestor->itemCount -= removedCount;
+            }
+
+            for(int i = 3; i >= 0; i--) {
+                if(currentNode->children[i].itemCount > 0 && bound.overlaps(currentNode->childrenBounds[i])) {
+                    nodeStack[stackSize++] = &currentNode->children[i];
+                }
+            }
+        }
+
+        // Every task modifies only its own subtree, and collects the removed handles instead of erasing them from the shared container
+        std::vector<std::vector<Handle>> removedItems(taskNodes.size());
+        std::vector<std::size_t> countsBefore(taskNodes.size());
+        for(std::size_t i = 0; i < taskNodes.size(); i++) {
+            countsBefore[i] = taskNodes[i]->itemCount;
+        }
+        runParallel(taskNodes.size(), threadCount, [&](std::size_t task, unsigned) {
+            QueryScratch scratch;
+            std::vector<Handle> &removed = removedItems[task];
+            taskNodes[task]->template remove<wholeNodeMatch>(bound, [&removed](const Handle &item) {removed.push_back(item);}, predicateFn, scratch, itemLocations);
+        });
+
+        // Once the tasks are done, erase the removed items, and update the counts above the subtrees
+        for(std::size_t i = 0; i < taskNodes.size(); i++) {
+            for(const auto &item : removedItems[i]) {
+                itemContainer->erase(item);
+            }
+            std::size_t removedCount = countsBefore[i] - taskNodes[i]->itemCount;
+            for(QuadTreeNode *ancestor = taskNodes[i]->parent; ancestor; ancestor = ancestor->parent) {
+                ancestor->itemCount -= removedCount;
+            }
+        }
+    }
+
+    // Removes the elements from the tree that overlap with/are contained in the given bound, based on the binary predicate function.
+    template <typename T>
+    template <bool wholeNodeMatch, typename Predicate, typename RemovedCallback>
+    void QuadTree<T>::QuadTreeNode::remove(const qt::Bound bound, RemovedCallback removedFn, Predicate predicateFn, QueryScratch &scratch,
+            std::vector<ItemLocation> &itemLocations) {
+        // All the QuadTreeNodes that are to be inspected for removal, and all the QuadTreeNodes whose all items
+        // should be removed. The stacks of the scratch are reused, so their memory is kept between the removals.
+        std::vector<QuadTreeNode*> &nodeRemoveStack = scratch.nodeStack;
+        std::vector<QuadTreeNode*> &allItemNodeStack = scratch.allItemNodeStack;
+        nodeRemoveStack.clear();
+        allItemNodeStack.clear();
+        
+        // Let's start the search with "this" node (usually the root)
+        nodeRemoveStack.push_back(this);
+        QuadTreeNode *currentNode;
+        while(!nodeRemoveStack.empty()) {
+            // Extract the next node from the stack
+            currentNode = nodeRemoveStack.back();
+            nodeRemoveStack.pop_back();
+
+            // If we encountered a node that is fully contained within the bounds of inerest
+            // (and the predicate is known to accept all of its items, which is decided at compile time).
+            // The root is not taken as a whole, the elements outside of the tree bound are kept in it.
+            if(wholeNodeMatch && currentNode != this && bound.contains(currentNode->bound)) {
+                // We are done with this node, all of its and its children's items should be removed,
+                // so add it to the other stack, and the subtree no longer counts in its ancestors (up to "this")
+                for(QuadTreeNode *ancestor = currentNode; ancestor != this; ) {
+                    ancestor = ancestor->parent;
+                    ancestor->itemCount -= currentNode->itemCount;
+                }
+                allItemNodeStack.push_back(currentNode);
+            } else {
+                // If it isn't fully contained, let's check its items against the bound (using the bounds
+                // stored in the node), and if an item overlaps/is within the bound, it should be removed,
+                // both from the outer container, and from the node
+                std::size_t removedCount = currentNode->items.size();
+                currentNode->items.removeIf(
+                    [&](const qt::Bound &itemBound) {return predicateFn(bound, itemBound);},
+                    removedFn,
+                    [&](const Handle &item, std::size_t position) {itemLocations[item.index].position = uint32_t(position);}
+                );
+
+                // The removed items no longer count in the node and its ancestors (up to "this")
+                removedCount -= currentNode->items.size();
+                for(QuadTreeNode *ancestor = currentNode; removedCount > 0; ancestor = ancestor->parent) {
+                    ancestor->itemCount -= removedCount;
+                    if(ancestor == this) {
+                        break;
+                    }
+                }
+
+                // Let's check the children of the current node, if it has any
+                for(int i = 0; i < 4 && currentNode->children; i++) {
+                    // If the child has items, and its bound overlaps the query bound
+                    if(currentNode->children[i].itemCount > 0 && bound.overlaps(currentNode->childrenBounds[i])) {
+                        // We have to investigate it too, so add it to the stack
+                        nodeRemoveStack.push_back(&currentNode->children[i]);
+                    }   
+                }
+            }
+        }
+
+        // We have to remove the items of the nodes that we know that
+        // are contained fully within the query bound
+        while(!allItemNodeStack.empty()) {
+            // extract the next node from the stack
+            currentNode = allItemNodeStack.back();
+            allItemNodeStack.pop_back();
+
+            // First remove all the items from the outer container
+            for(const auto &item : currentNode->items.handles) {
+                removedFn(item);
+            }
+            // Then clear the whole handle list, the subtree becomes empty
+            currentNode->items.clear();
+            currentNode->itemCount = 0;
+
+            // And also add all the non-empty children to this stack, so that their items can be removed
+            for(int i = 0; i < 4 && currentNode->children; i++) {
+                if(currentNode->children[i].itemCount > 0) {
+                    allItemNodeStack.push_back(&currentNode->children[i]);
+                }
+            }
+        }
+    }
+
+    // Appends the handles of the subtree to the spatially ordered container, and records the range of the subtree.
+    template <typename T>
+    void QuadTree<T>::QuadTreeNode::pack(std::vector<Handle> &packedItems) {
+        // The recursion is bounded by MAXDEPTH, and the pre-order makes every subtree contiguous
+        packedBegin = packedItems.size();
+        packedItems.insert(packedItems.end(), items.handles.begin(), items.handles.end());
+        for(int i = 0; i < 4 && children; i++) {
+            children[i].pack(packedItems);
+        }
+        packedEnd = packedItems.size();
+    }
+
+    // Returns all the boundaries that make up the tree.
+    template <typename T>
+    void QuadTree<T>::QuadTreeNode::getBounds(std::vector<Bound> &bounds) const {
+        // Visit all the nodes in a BFS style
+        std::queue<const QuadTreeNode*> nodeFIFO;
+
+         // Start with "this" node (usually the root)
+        nodeFIFO.push(this);
+
+        QuadTreeNode const *currentNode;
+        while(!nodeFIFO.empty()) {
+            // Take the next node
+            currentNode = nodeFIFO.front();
+            nodeFIFO.pop();
+
+            // Add its bound to the return container
+            bounds.push_back(currentNode->bound);
+
+            // aAd all its existing children to the FIFO
+            for(int i = 0; i < 4 && currentNode->children; i++) {
+                nodeFIFO.push(&currentNode->children[i]);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include "bound.hpp"        // qt::Bound
+#include "util.hpp"         // qt::Vec2D_f64
+
+#include <vector>           // std::vector
+#include <cstddef>          // std::size_t
+
+namespace qt {
+    /**
+     * @brief The relation of a bound to a search region.
+     */
+    enum class RegionRelation {OUTSIDE, PARTIAL, INSIDE};
+
+    /**
+     * @brief A convex polygon, which can be used as the search region of the region queries of the QuadTree.
+     * @note Any type can be used as a search region, if it has a classify(const Bound&) const method that returns
+     *      the RegionRelation of the bound. The classification has to be exact for INSIDE (every point of the bound
+     *      is in the region), and it may only return OUTSIDE if no point of the bound is in the region.
+     */
+    class ConvexPolygon {
+        public:
+            /**
+             * @brief Constructs the polygon from its vertices.
+             * @param vertices The vertices of a convex polygon, in clockwise or counter-clockwise order.
+             */
+            ConvexPolygon(const std::vector<Vec2D_f64> &vertices);
+
+            /**
+             * @brief Decides whether a bound is fully inside, fully outside, or partially inside the polygon.
+             * @param bound The bound that it needs to be checked against.
+             * @return INSIDE if the polygon contains the bound, OUTSIDE if they have no common point, PARTIAL otherwise.
+             * @note The bound and the polygon are both closed, so touching is considered PARTIAL. It is exact: the polygon
+             *      contains the bound iff. it contains its four corners, and they are disjoint iff. either the sides
+             *      of the bound or one of the edges of the polygon separate them.
+             */
+            RegionRelation classify(const Bound &bound) const;
+
+            /**
+             * @brief Returns the vertices of the polygon, in counter-clockwise order.
+             */
+            const std::vector<Vec2D_f64>& getVertices() const;
+
+        protected:
+            /**
+             * @brief Calculates on which side of the i-th edge a point lies.
+             * @return Positive if the point is on the inner side, negative if it is on the outer side, 0 if it is on the edge.
+             */
+            double side(std::size_t i, double x, double y) const;
+
+            /**
+             * @brief The vertices of the polygon, in counter-clockwise order, so that the inner side of every edge is on its left.
+             */
+            std::vector<Vec2D_f64> vertices;
+
+            /**
+             * @brief The axis aligned bounding box of the polygon.
+             */
+            double minX, minY, maxX, maxY;
+    };
+
+    /*------------------------------------------------
+            ConvexPolygon class implementation
+    --------------------------------------------------*/
+
+    // Constructs the polygon from its vertices.
+    inline ConvexPolygon::ConvexPolygon(const std::vector<Vec2D_f64> &vertices) : vertices(vertices), minX(0), minY(0), maxX(0), maxY(0) {
+        // Twice the signed area of the polygon, its sign tells the order of the vertices
+        double area = 0;
+        for(std::size_t i = 0; i < vertices.size(); i++) {
+            const Vec2D_f64 &a = vertices[i], &b = vertices[(i + 1) % vertices.size()];
+            area += a.x * b.y - b.x * a.y;
+        }
+
+        // Turn the vertices counter-clockwise, so that the side() of the inner points is positive
+        if(area < 0) {
+            this->vertices.assign(vertices.rbegin(), vertices.rend());
+        }
+
+        // And the bounding box, which is the separating axis of the sides of the bounds
+        for(std::size_t i = 0; i < vertices.size(); i++) {
+            const Vec2D_f64 &v = vertices[i];
+            minX = (i == 0 || v.x < minX) ? v.x : minX;
+            minY = (i == 0 || v.y < minY) ? v.y : minY;
+            maxX = (i == 0 || v.x > maxX) ? v.x : maxX;
+            maxY = (i == 0 || v.y > maxY) ? v.y : maxY;
+        }
+    }
+
+    // Decides whether a bound is fully inside, fully outside, or partially inside the polygon.
+    inline RegionRelation ConvexPolygon::classify(const Bound &bound) const {
+        // An empty polygon has no points
+        if(vertices.empty()) {
+            return RegionRelation::OUTSIDE;
+        }
+
+        // If the bounding box of the polygon doesn't overlap the bound, the sides of the bound separate them
+        if(maxX < bound.topLeft.x || minX > bound.bottomRight.x || maxY < bound.topLeft.y || minY > bound.bottomRight.y) {
+            return RegionRelation::OUTSIDE;
+        }
+
+        const double cornersX[4] = {double(bound.topLeft.x), double(bound.bottomRight.x), double(bound.topLeft.x), double(bound.bottomRight.x)};
+        const double cornersY[4] = {double(bound.topLeft.y), double(bound.topLeft.y), double(bound.bottomRight.y), double(bound.bottomRight.y)};
+
+        bool allInside = true;
+        for(std::size_t i = 0; i < vertices.size(); i++) {
+            // Count the corners that are on the outer side of the edge
+            int outsideCount = 0;
+            for(int j = 0; j < 4; j++) {
+                if(side(i, cornersX[j], cornersY[j]) < 0) {
+                    outsideCount++;
+                }
+            }
+
+            // If all the corners are outside, the edge separates the bound from the polygon
+            if(outsideCount == 4) {
+                return RegionRelation::OUTSIDE;
+            }
+            allInside = allInside && outsideCount == 0;
+        }
+
+        return allInside ? RegionRelation::INSIDE : RegionRelation::PARTIAL;
+    }
+
+    // Returns the vertices of the polygon, in counter-clockwise order.
+    inline const std::vector<Vec2D_f64>& ConvexPolygon::getVertices() const {
+        return vertices;
+    }
+
+    // Calculates on which side of the i-th edge a point lies.
+    inline double ConvexPolygon::side(std::size_t i, double x, double y) const {
+        const Vec2D_f64 &a = vertices[i], &b = vertices[(i + 1) % vertices.size()];
+        // The cross product of the edge and the vector pointing from its start to the point
+        return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,175 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include "util.hpp"         // qt::uint32_t
+
+#include <vector>           // std::vector
+#include <cstddef>          // std::size_t
+
+namespace qt {
+    /**
+     * @brief A dense, contiguous container which hands out stable generational handles to its elements.
+     * @tparam T The type of the stored elements.
+     * @note The elements are kept packed in a single std::vector, so a full scan runs over contiguous memory,
+     *      while a handle stays valid until its own element is erased, no matter how many other elements are
+     *      inserted or erased in the meantime. Insertion and erasure are O(1), and they only touch the allocator
+     *      when the underlying vectors have to grow.
+     */
+    template <typename T>
+    class SlotMap {
+        public:
+            /**
+             * @brief Identifies an element of the SlotMap. It is made up of the index of the slot
+             *      in which the element is registered, and the generation of that slot upon insertion.
+             * @note After the element is erased, the generation of its slot is incremented,
+             *      so that the old handle can no longer be resolved, even if the slot is reused.
+             */
+            struct Handle {
+                uint32_t index;
+                uint32_t generation;
+
+                /**
+                 * @brief Decides whether two handles identify the same element.
+                 */
+                bool operator==(const Handle &other) const {return index == other.index && generation == other.generation;}
+
+                /**
+                 * @brief Decides whether two handles identify different elements.
+                 */
+                bool operator!=(const Handle &other) const {return !(*this == other);}
+            };
+
+            /**
+             * @brief Iterator types over the densely stored elements (in no particular order).
+             */
+            typedef typename std::vector<T>::iterator iterator;
+            typedef typename std::vector<T>::const_iterator const_iterator;
+
+            /**
+             * @brief Constructs an empty SlotMap.
+             */
+            SlotMap();
+
+            /**
+             * @brief Inserts a copy of the given element.
+             * @param[in] value The element that needs to be inserted.
+             * @return The handle that identifies the newly inserted element.
+             */
+            Handle insert(const T &value);
+
+            /**
+             * @brief Inserts the given element, by moving it.
+             * @param[in] value The element that needs to be inserted.
+             * @return The handle that identifies the newly inserted element.
+             */
+            Handle insert(T &&value);
+
+            /**
+             * @brief Inserts an element constructed in place from the given arguments.
+             * @param[in] args The arguments forwarded to the constructor of T.
+             * @return The handle that identifies the newly inserted element.
+             */
+            template <typename... Args>
+            Handle emplace(Args&&... args);
+
+            /**
+             * @brief Erases the element identified by the handle, by moving the last element in its place.
+             * @param[in] handle The handle of the element that needs to be erased.
+             * @note Erasing with an invalid (already erased) handle has no effect.
+             */
+            void erase(const Handle &handle);
+
+            /**
+             * @brief Decides whether the handle still identifies an element of the SlotMap.
+             * @param[in] handle The handle that needs to be checked.
+             * @return true if the element of the handle hasn't been erased yet, false otherwise.
+             */
+            bool contains(const Handle &handle) const;
+
+            /**
+             * @brief Accesses the element identified by the handle.
+             * @param[in] handle A valid handle of the SlotMap.
+             * @return A reference to the element.
+             * @note The handle is not checked for validity, see SlotMap<T>::contains.
+             */
+            T& operator[](const Handle &handle);
+
+            /**
+             * @brief Accesses the element identified by the handle.
+             * @param[in] handle A valid handle of the SlotMap.
+             * @return A const reference to the element.
+             * @note The handle is not checked for validity, see SlotMap<T>::contains.
+             */
+            const T& operator[](const Handle &handle) const;
+
+            /**
+             * @brief Returns the number of stored elements.
+             */
+            std::size_t size() const;
+
+            /**
+             * @brief Decides whether the SlotMap has no elements.
+             */
+            bool empty() const;
+
+            /**
+             * @brief Reserves memory for the given number of elements.
+             */
+            void reserve(std::size_t capacity);
+
+            /**
+             * @brief Erases all the elements, and invalidates all the handles.
+             */
+            void clear();
+
+            /**
+             * @brief Iterators to the beginning and the end of the dense element storage.
+             * @note They are invalidated by insertion and erasure, unlike the handles.
+             */
+            iterator begin();
+            iterator end();
+            const_iterator begin() const;
+            const_iterator end() const;
+
+        protected:
+            /**
+             * @brief Marks the end of the free slot list.
+             */
+            static const uint32_t NONE = 0xFFFFFFFF;
+
+            /**
+             * @brief The indirection entry of a handle.
+             * @note For a used slot, dense is the position of the element in the values vector,
+             *      for a free slot, it is the index of the next free slot.
+             */
+            struct Slot {
+                uint32_t dense;
+                uint32_t generation;
+            };
+
+            /**
+             * @brief The densely stored elements.
+             */
+            std::vector<T> values;
+
+            /**
+             * @brief The slot index of each element, parallel to the values vector.
+             */
+            std::vector<uint32_t> valueSlots;
+
+            /**
+             * @brief The slots, indexed by Handle::index.
+             */
+            std::vector<Slot> slots;
+
+            /**
+             * @brief The head of the free slot list.
+             */
+            uint32_t freeHead;
+    };
+}
+
+// The template definitions, so that the class can be used header-only, without explicit instantiation
+#include "slotmap.tpp"
+
+#endif
\ No newline at end of file
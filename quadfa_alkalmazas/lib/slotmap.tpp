@@ -0,0 +1,145 @@
+#include "slotmap.hpp"      // class declarations
+
+#include <utility>          // std::move, std::forward
+
+namespace qt {
+    /*------------------------------------------------
+            SlotMap template class implementation
+    --------------------------------------------------*/
+
+    // Constructs an empty SlotMap.
+    template <typename T>
+    SlotMap<T>::SlotMap() : freeHead(NONE) {}
+
+    // Inserts a copy of the given element.
+    template <typename T>
+    typename SlotMap<T>::Handle SlotMap<T>::insert(const T &value) {
+        return emplace(value);
+    }
+
+    // Inserts the given element, by moving it.
+    template <typename T>
+    typename SlotMap<T>::Handle SlotMap<T>::insert(T &&value) {
+        return emplace(std::move(value));
+    }
+
+    // Inserts an element constructed in place from the given arguments.
+    template <typename T>
+    template <typename... Args>
+    typename SlotMap<T>::Handle SlotMap<T>::emplace(Args&&... args) {
+        uint32_t slotIndex;
+
+        // Reuse a free slot if there is one, otherwise register a new slot
+        if(freeHead != NONE) {
+            slotIndex = freeHead;
+            freeHead = slots[slotIndex].dense;
+        } else {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot{NONE, 0});
+        }
+
+        // The element goes to the end of the dense storage
+        slots[slotIndex].dense = static_cast<uint32_t>(values.size());
+        values.emplace_back(std::forward<Args>(args)...);
+        valueSlots.push_back(slotIndex);
+
+        return Handle{slotIndex, slots[slotIndex].generation};
+    }
+
+    // Erases the element identified by the handle, by moving the last element in its place.
+    template <typename T>
+    void SlotMap<T>::erase(const Handle &handle) {
+        if(!contains(handle)) {
+            return;
+        }
+
+        Slot &slot = slots[handle.index];
+        uint32_t last = static_cast<uint32_t>(values.size()) - 1;
+
+        // Fill the gap with the last element, and redirect the slot of the moved element
+        if(slot.dense != last) {
+            values[slot.dense] = std::move(values[last]);
+            valueSlots[slot.dense] = valueSlots[last];
+            slots[valueSlots[slot.dense]].dense = slot.dense;
+        }
+        values.pop_back();
+        valueSlots.pop_back();
+
+        // Invalidate the old handles of the slot, and put it in the free list
+        slot.generation++;
+        slot.dense = freeHead;
+        freeHead = handle.index;
+    }
+
+    // Decides whether the handle still identifies an element of the SlotMap.
+    template <typename T>
+    bool SlotMap<T>::contains(const Handle &handle) const {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+    }
+
+    // Accesses the element identified by the handle.
+    template <typename T>
+    T& SlotMap<T>::operator[](const Handle &handle) {
+        return values[slots[handle.index].dense];
+    }
+
+    // Accesses the element identified by the handle.
+    template <typename T>
+    const T& SlotMap<T>::operator[](const Handle &handle) const {
+        return values[slots[handle.index].dense];
+    }
+
+    // Returns the number of stored elements.
+    template <typename T>
+    std::size_t SlotMap<T>::size() const {
+        return values.size();
+    }
+
+    // Decides whether the SlotMap has no elements.
+    template <typename T>
+    bool SlotMap<T>::empty() const {
+        return values.empty();
+    }
+
+    // Reserves memory for the given number of elements.
+    template <typename T>
+    void SlotMap<T>::reserve(std::size_t capacity) {
+        values.reserve(capacity);
+        valueSlots.reserve(capacity);
+        slots.reserve(capacity);
+    }
+
+    // Erases all the elements, and invalidates all the handles.
+    template <typename T>
+    void SlotMap<T>::clear() {
+        // The slots are kept (with increased generation), so that no old handle becomes valid again
+        for(const auto &slotIndex : valueSlots) {
+            slots[slotIndex].generation++;
+            slots[slotIndex].dense = freeHead;
+            freeHead = slotIndex;
+        }
+        values.clear();
+        valueSlots.clear();
+    }
+
+    // Iterators to the beginning and the end of the dense element storage.
+    template <typename T>
+    typename SlotMap<T>::iterator SlotMap<T>::begin() {
+        return values.begin();
+    }
+
+    template <typename T>
+    typename SlotMap<T>::iterator SlotMap<T>::end() {
+        return values.end();
+    }
+
+    template <typename T>
+    typename SlotMap<T>::const_iterator SlotMap<T>::begin() const {
+        return values.begin();
+    }
+
+    template <typename T>
+    typename SlotMap<T>::const_iterator SlotMap<T>::end() const {
+        return values.end();
+    }
+}
\ No newline at end of file
@@ -2,12 +2,13 @@
 #define OLC_PGE_APPLICATION
 #include "olc/olcPixelGameEngine.h"
 
-#include "shape_container.hpp"      // RectangleContainer, QuadTreeContainer, LinearContainer
+#include "shape_container.hpp"      // RectangleContainer, QuadTreeContainer, LinearQuadTreeContainer, LinearContainer
 
 #include <cstdlib>                  // srand()
 #include <ctime>                    // time()
 #include <string>                   // std::string
 #include <chrono>                   // std::chrono
+#include <utility>                  // std::move
 
 class QuadTreeDemo : public olc::PixelGameEngine
 {
@@ -16,7 +17,7 @@ class QuadTreeDemo : public olc::PixelGameEngine
         int minSizeRect;                                    // the minimum size of a Shape (important upon populating the containers)
         int maxSizeRect;                                    // the maximum size of a Shape (important upon populating the containers)
 
-        enum SCType {QUAD_TREE = 0, LINEAR, SCSIZE};        // the indices of the different containers (SC - ShapeContainer)
+        enum SCType {QUAD_TREE = 0, LINEAR_QUAD_TREE, LINEAR, SCSIZE};        // the indices of the different containers (SC - ShapeContainer)
         enum QRType {OVERLAP = 0, CONTAIN, QRSIZE};         // the types of query/remove operations (QR - Query/Remove)
 
         ShapeContainer* containers[SCType::SCSIZE];      
@@ -30,6 +31,7 @@ class QuadTreeDemo : public olc::PixelGameEngine
 
         qt::Bound screenBound;                              // bounds of the screen ({0, 0}, {width-1, height-1})
         olc::vf2d queryBoundSize = olc::vf2d(100, 100);     // size of the query rectangle
+        std::vector<const Shape*> query;                    // results of the queries, the buffer is reused in every frame
         olc::vf2d textScale;                                // scale of text according to the size of the screen
         olc::vf2d textOffset;                               // offset of text according to the size of the screen (for better visibility)
 
@@ -50,7 +52,8 @@ class QuadTreeDemo : public olc::PixelGameEngine
             Clear(BACKGROUND_COL);
 
             // get all of the Rectangles in the frame from the LinearContainer (faster in this case)
-            auto query = containers[SCType::LINEAR]->queryOverlap(screenBound);
+            query.clear();
+            containers[SCType::LINEAR]->queryOverlap(screenBound, query);
             for(const auto &item : query) {
                 // draw one Shape at a time
                 FillRect({item->topLeft.x, item->topLeft.y}, {item->bottomRight.x - item->topLeft.x, item->bottomRight.y - item->topLeft.y}, {item->color.r, item->color.g, item->color.b});
@@ -59,7 +62,7 @@ class QuadTreeDemo : public olc::PixelGameEngine
             // how many Rectangles are on the screen
             nrItems = query.size();
 
-            // for all the containers (2), get the boundaries and draw them to a different sprite, together with the Rectangles
+            // for all the containers (3), get the boundaries and draw them to a different sprite, together with the Rectangles
             for(int i = 0; i < SCType::SCSIZE; i++) {
                 SetDrawTarget(boundSprites[i]);
                 DrawSprite({0, 0}, rectangleSprite);
@@ -92,21 +95,26 @@ class QuadTreeDemo : public olc::PixelGameEngine
 
             // instantiate the RectangleContainers
             containers[SCType::QUAD_TREE] = new QuadTreeContainer(screenBound);
+            containers[SCType::LINEAR_QUAD_TREE] = new LinearQuadTreeContainer(screenBound);
             containers[SCType::LINEAR] = new LinearContainer(screenBound);
 
             // let's create the given ammount of Rectangles, randomly
+            std::vector<Shape> shapes;
+            shapes.reserve(nrItems);
             for(int i = 0; i < nrItems; i++) {
-                Shape r = Shape::getRandomGrayShape(screenBound, qt::Vec2D_i32(minSizeRect, minSizeRect), qt::Vec2D_i32(maxSizeRect, maxSizeRect));
-
-                // insert it in both of the containers
-                containers[SCType::QUAD_TREE]->insert(r);
-                containers[SCType::LINEAR]->insert(r);
+                shapes.push_back(Shape::getRandomGrayShape(screenBound, qt::Vec2D_i32(minSizeRect, minSizeRect), qt::Vec2D_i32(maxSizeRect, maxSizeRect)));
             }
 
+            // and load them in all of the containers at once (the last one can take them over)
+            containers[SCType::QUAD_TREE]->insert(shapes);
+            containers[SCType::LINEAR_QUAD_TREE]->insert(shapes);
+            containers[SCType::LINEAR]->insert(std::move(shapes));
+
             // init the sprites
             rectangleSprite = new olc::Sprite(ScreenWidth(), ScreenHeight());
-            boundSprites[0] = new olc::Sprite(ScreenWidth(), ScreenHeight());
-            boundSprites[1] = new olc::Sprite(ScreenWidth(), ScreenHeight());
+            for(int i = 0; i < SCType::SCSIZE; i++) {
+                boundSprites[i] = new olc::Sprite(ScreenWidth(), ScreenHeight());
+            }
 
             // draw the Rectangles and bounds to the sprites
             updateSprites();
@@ -140,7 +148,8 @@ class QuadTreeDemo : public olc::PixelGameEngine
             if(GetKey(olc::A).bReleased) {
                 Shape r = Shape(qt::Vec2D_i32(queryBoundTopLeft.x, queryBoundTopLeft.y), qt::Vec2D_i32(queryBoundBottomRight.x, queryBoundBottomRight.y), Shape::Color(255, 255, 255));
                 containers[SCType::QUAD_TREE]->insert(r);
-                containers[SCType::LINEAR]->insert(r);
+                containers[SCType::LINEAR_QUAD_TREE]->insert(r);
+                containers[SCType::LINEAR]->insert(std::move(r));
                 updateSprites();
             }
 
@@ -149,10 +158,12 @@ class QuadTreeDemo : public olc::PixelGameEngine
                 switch(opType) {
                     case QRType::OVERLAP:
                         containers[SCType::QUAD_TREE]->removeOverlap(queryBound);
+                        containers[SCType::LINEAR_QUAD_TREE]->removeOverlap(queryBound);
                         containers[SCType::LINEAR]->removeOverlap(queryBound);
                         break;
                     case QRType::CONTAIN:
                         containers[SCType::QUAD_TREE]->removeContain(queryBound);
+                        containers[SCType::LINEAR_QUAD_TREE]->removeContain(queryBound);
                         containers[SCType::LINEAR]->removeContain(queryBound);
                         break;
                     default:
@@ -173,7 +184,7 @@ class QuadTreeDemo : public olc::PixelGameEngine
 
             // switch container with SPACE key
             if(GetKey(olc::SPACE).bPressed) {
-                currentContainer = static_cast<SCType>(currentContainer ^ 1);
+                currentContainer = static_cast<SCType>((currentContainer + 1) % SCType::SCSIZE);
             }
 
             // toggle message text
@@ -181,17 +192,17 @@ class QuadTreeDemo : public olc::PixelGameEngine
                 displayHelp ^= 1;
             }
 
-            // get the results of the query in this vector
-            std::vector<std::list<Shape>::iterator> query;
+            // get the results of the query in the reused vector
+            query.clear();
 
             // make a query, and also measure the time
             auto clockStart = std::chrono::high_resolution_clock::now();
             switch(opType) {
                 case QRType::OVERLAP:
-                    query = containers[currentContainer]->queryOverlap(queryBound);
+                    containers[currentContainer]->queryOverlap(queryBound, query);
                     break;
                 case QRType::CONTAIN:
-                    query = containers[currentContainer]->queryContain(queryBound);
+                    containers[currentContainer]->queryContain(queryBound, query);
                     break;
                 default:
                     break;
@@ -208,7 +219,7 @@ class QuadTreeDemo : public olc::PixelGameEngine
                 DrawSprite({0, 0}, rectangleSprite);
             }
 
-            // iterate through the std::list<Shape>::iterators, and draw the Rectangles on the screen with different color
+            // iterate through the pointers to the found Shapes, and draw the Rectangles on the screen with different color
             for(const auto& item : query) {
                  FillRect({item->topLeft.x, item->topLeft.y}, {item->bottomRight.x - item->topLeft.x, item->bottomRight.y - item->topLeft.y}, QUERY_OBJ_COL);
             }
@@ -220,6 +231,8 @@ class QuadTreeDemo : public olc::PixelGameEngine
             std::string currentContainerStr;
             if(currentContainer == SCType::QUAD_TREE) {
                 currentContainerStr = "QuadTree";
+            } else if(currentContainer == SCType::LINEAR_QUAD_TREE) {
+                currentContainerStr = "LinearQuadTree";
             } else {
                 currentContainerStr = "Linear";
             }
@@ -245,6 +258,8 @@ class QuadTreeDemo : public olc::PixelGameEngine
             delete rectangleSprite;
             delete containers[SCType::QUAD_TREE];
             delete boundSprites[SCType::QUAD_TREE];
+            delete containers[SCType::LINEAR_QUAD_TREE];
+            delete boundSprites[SCType::LINEAR_QUAD_TREE];
             delete containers[SCType::LINEAR];
             delete boundSprites[SCType::LINEAR];
             return true;
@@ -1,10 +1,41 @@
 #include "shape_container.hpp"      // class declarations
 
+#include <utility>                  // std::move
+#include <iterator>                 // std::make_move_iterator
+
 /*------------------------------------------------
         ShapeContainer class definitions
 --------------------------------------------------*/
 ShapeContainer::ShapeContainer(const qt::Bound &bound) : bound(bound) {}
 
+// Insert several shapes in the container at once.
+void ShapeContainer::insert(const std::vector<Shape> &shapes) {
+    for(const Shape &shape : shapes) {
+        insert(shape);
+    }
+}
+
+// Insert several shapes in the container at once, by moving them.
+void ShapeContainer::insert(std::vector<Shape> &&shapes) {
+    for(Shape &shape : shapes) {
+        insert(std::move(shape));
+    }
+}
+
+// Searches the container for elements that overlap with the given bound.
+std::vector<const Shape*> ShapeContainer::queryOverlap(const qt::Bound &bound) {
+    std::vector<const Shape*> returnItems;
+    queryOverlap(bound, returnItems);
+    return returnItems;
+}
+
+// Searches the container for elements that are contained within the given bound.
+std::vector<const Shape*> ShapeContainer::queryContain(const qt::Bound &bound) {
+    std::vector<const Shape*> returnItems;
+    queryContain(bound, returnItems);
+    return returnItems;
+}
+
 /*------------------------------------------------
         QuadTreeContainer class definitions
 --------------------------------------------------*/
@@ -17,24 +48,64 @@ void QuadTreeContainer::insert(const Shape &itemWithBound) {
     itemContainer_qt.insert(itemWithBound);
 }
 
-// Searches the container for elements that overlap with the given bound.
-std::vector<std::list<Shape>::iterator> QuadTreeContainer::queryOverlap(const qt::Bound &bound) {
-    return itemContainer_qt.queryOverlap(bound);
+// Insert a shape in the container, by moving it.
+void QuadTreeContainer::insert(Shape &&itemWithBound) {
+    itemContainer_qt.insert(std::move(itemWithBound));
 }
 
-// Searches the container for elements that are contained within the given bound.
-std::vector<std::list<Shape>::iterator> QuadTreeContainer::queryContain(const qt::Bound &bound) {
-    return itemContainer_qt.queryContain(bound);
+// Insert several shapes in the container at once, with bulk loading if the container is empty.
+void QuadTreeContainer::insert(const std::vector<Shape> &shapes) {
+    // Building replaces the content of the tree, so it can only be used for the first shapes
+    if(itemContainer_qt.size() == 0) {
+        itemContainer_qt.build(shapes.begin(), shapes.end());
+    } else {
+        ShapeContainer::insert(shapes);
+    }
+}
+
+// Insert several shapes in the container at once by moving them, with bulk loading if the container is empty.
+void QuadTreeContainer::insert(std::vector<Shape> &&shapes) {
+    if(itemContainer_qt.size() == 0) {
+        itemContainer_qt.build(std::make_move_iterator(shapes.begin()), std::make_move_iterator(shapes.end()));
+    } else {
+        ShapeContainer::insert(std::move(shapes));
+    }
+}
+
+// Searches the container for elements that overlap with the given bound, appending them to the given container.
+void QuadTreeContainer::queryOverlap(const qt::Bound &bound, std::vector<const Shape*> &foundItems) {
+    // Lay out the shapes in spatial order (if anything has changed), so that fully covered subtrees are found at once
+    itemContainer_qt.pack();
+
+    // The handles are resolved range by range, without collecting them in a temporary container
+    itemContainer_qt.forEachOverlapRange(bound, [&](const qt::QuadTree<Shape>::Handle *first, const qt::QuadTree<Shape>::Handle *last) {
+        for(; first != last; ++first) {
+            foundItems.push_back(&itemContainer_qt[*first]);
+        }
+    });
+}
+
+// Searches the container for elements that are contained within the given bound, appending them to the given container.
+void QuadTreeContainer::queryContain(const qt::Bound &bound, std::vector<const Shape*> &foundItems) {
+    // Lay out the shapes in spatial order (if anything has changed), so that fully covered subtrees are found at once
+    itemContainer_qt.pack();
+
+    // The handles are resolved range by range, without collecting them in a temporary container
+    itemContainer_qt.forEachContainRange(bound, [&](const qt::QuadTree<Shape>::Handle *first, const qt::QuadTree<Shape>::Handle *last) {
+        for(; first != last; ++first) {
+            foundItems.push_back(&itemContainer_qt[*first]);
+        }
+    });
 }
 
 // Removes all elements from the container that overlap with the given bound.
 void QuadTreeContainer::removeOverlap(const qt::Bound &bound) {
-    itemContainer_qt.removeOverlap(bound);
+    itemContainer_qt.removeOverlap(bound, scratch_qt);
 }
 
 // Removes all elements from the container that are fully contained within the given bound.
 void QuadTreeContainer::removeContain(const qt::Bound &bound) {
-    itemContainer_qt.removeContain(bound);
+    itemContainer_qt.removeContain(bound, scratch_qt);
 }
 
 // Returns all the boundaries that make up the inner structure of the container.
@@ -42,6 +113,64 @@ std::vector<qt::Bound> QuadTreeContainer::getBounds() {
     return itemContainer_qt.getBounds();
 }
 
+/*------------------------------------------------
+     LinearQuadTreeContainer class definitions
+--------------------------------------------------*/
+
+// Construct a LinearQuadTreeContainer with given bound.
+LinearQuadTreeContainer::LinearQuadTreeContainer(const qt::Bound &bound) : ShapeContainer(bound), itemContainer_lqt(bound) {}
+
+// Insert a shape in the container.
+void LinearQuadTreeContainer::insert(const Shape &itemWithBound) {
+    itemContainer_lqt.insert(itemWithBound);
+}
+
+// Insert a shape in the container, by moving it.
+void LinearQuadTreeContainer::insert(Shape &&itemWithBound) {
+    itemContainer_lqt.insert(std::move(itemWithBound));
+}
+
+// Searches the container for elements that overlap with the given bound, appending them to the given container.
+void LinearQuadTreeContainer::queryOverlap(const qt::Bound &bound, std::vector<const Shape*> &foundItems) {
+    // Sort the newly inserted shapes into their levels (if there are any), so that they are found through their nodes
+    itemContainer_lqt.pack();
+
+    // The handles are resolved range by range, without collecting them in a temporary container
+    itemContainer_lqt.forEachOverlapRange(bound, [&](const qt::LinearQuadTree<Shape>::Handle *first, const qt::LinearQuadTree<Shape>::Handle *last) {
+        for(; first != last; ++first) {
+            foundItems.push_back(&itemContainer_lqt[*first]);
+        }
+    });
+}
+
+// Searches the container for elements that are contained within the given bound, appending them to the given container.
+void LinearQuadTreeContainer::queryContain(const qt::Bound &bound, std::vector<const Shape*> &foundItems) {
+    // Sort the newly inserted shapes into their levels (if there are any), so that they are found through their nodes
+    itemContainer_lqt.pack();
+
+    // The handles are resolved range by range, without collecting them in a temporary container
+    itemContainer_lqt.forEachContainRange(bound, [&](const qt::LinearQuadTree<Shape>::Handle *first, const qt::LinearQuadTree<Shape>::Handle *last) {
+        for(; first != last; ++first) {
+            foundItems.push_back(&itemContainer_lqt[*first]);
+        }
+    });
+}
+
+// Removes all elements from the container that overlap with the given bound.
+void LinearQuadTreeContainer::removeOverlap(const qt::Bound &bound) {
+    itemContainer_lqt.removeOverlap(bound, scratch_lqt);
+}
+
+// Removes all elements from the container that are fully contained within the given bound.
+void LinearQuadTreeContainer::removeContain(const qt::Bound &bound) {
+    itemContainer_lqt.removeContain(bound, scratch_lqt);
+}
+
+// Returns all the boundaries that make up the inner structure of the container.
+std::vector<qt::Bound> LinearQuadTreeContainer::getBounds() {
+    return itemContainer_lqt.getBounds();
+}
+
 /*------------------------------------------------
         LinearContainer class definitions
 --------------------------------------------------*/
@@ -55,24 +184,26 @@ void LinearContainer::insert(const Shape &itemWithBound) {
         itemContainer_list.push_back(itemWithBound);
 }
 
-// Searches the container for elements that overlap with the given bound.
-std::vector<std::list<Shape>::iterator> LinearContainer::queryOverlap(const qt::Bound &bound) {
-    std::vector<std::list<Shape>::iterator> returnItems;
+// Insert a shape in the container, by moving it.
+void LinearContainer::insert(Shape &&itemWithBound) {
+    if(this->bound.contains(bound))
+        itemContainer_list.push_back(std::move(itemWithBound));
+}
+
+// Searches the container for elements that overlap with the given bound, appending them to the given container.
+void LinearContainer::queryOverlap(const qt::Bound &bound, std::vector<const Shape*> &foundItems) {
     for(auto it = itemContainer_list.begin(); it != itemContainer_list.end(); ++it) {
         if(bound.overlaps(*it))
-            returnItems.push_back(it);
+            foundItems.push_back(&*it);
     }
-    return returnItems;
 }
 
-// Searches the container for elements that are contained within the given bound.
-std::vector<std::list<Shape>::iterator> LinearContainer::queryContain(const qt::Bound &bound) {
-    std::vector<std::list<Shape>::iterator> returnItems;
+// Searches the container for elements that are contained within the given bound, appending them to the given container.
+void LinearContainer::queryContain(const qt::Bound &bound, std::vector<const Shape*> &foundItems) {
     for(auto it = itemContainer_list.begin(); it != itemContainer_list.end(); ++it) {
         if(bound.contains(*it))
-            returnItems.push_back(it);
+            foundItems.push_back(&*it);
     }
-    return returnItems;
 }
 
 // Removes all elements from the container that overlap with the given bound.
@@ -2,6 +2,7 @@
 #define RECTANGLE_CONTAINER_H
 
 #include "lib/quadtree.hpp"         // qt::QuadTree<Rectangle>
+#include "lib/linear_quadtree.hpp"  // qt::LinearQuadTree<Rectangle>
 #include "lib/bound.hpp"            // qt::Bound
 #include "lib/util.hpp"             // qt::Vec2D_i32
 #include "shape.hpp"                // Shape
@@ -24,21 +25,54 @@ class ShapeContainer {
          */
         virtual void insert(const Shape &shape) = 0;     
 
+        /**
+         * @brief Insert a shape in the container, by moving it.
+         * @note Pure virtual (abstract) method, should be implemented.
+         */
+        virtual void insert(Shape &&shape) = 0;
+
+        /**
+         * @brief Insert several shapes in the container at once.
+         * @note By default they are inserted one by one, the inheriting classes may load them faster.
+         */
+        virtual void insert(const std::vector<Shape> &shapes);
+
+        /**
+         * @brief Insert several shapes in the container at once, by moving them.
+         * @note By default they are inserted one by one, the inheriting classes may load them faster.
+         */
+        virtual void insert(std::vector<Shape> &&shapes);
+
         /**
          * @brief Searches the container for elements that overlap with the given bound.
          * @param bound The search bound that all the found elements should overlap with.
-         * @return A std::vector of std::list<Shape>::iterators, which point to the found elements. 
-         * @note Pure virtual (abstract) method, should be implemented.
+         * @return A std::vector of pointers to the found elements, valid until the container is modified.
          */
-        virtual std::vector<std::list<Shape>::iterator> queryOverlap(const qt::Bound &bound) = 0;
+        std::vector<const Shape*> queryOverlap(const qt::Bound &bound);
+
+        /**
+         * @brief Searches the container for elements that overlap with the given bound, into a caller-owned container.
+         * @param bound The search bound that all the found elements should overlap with.
+         * @param foundItems The pointers to the found elements are appended to it, they are valid until the container is modified.
+         * @note Pure virtual (abstract) method, should be implemented. Reusing the same std::vector for every
+         *      query avoids allocating a new result for each of them.
+         */
+        virtual void queryOverlap(const qt::Bound &bound, std::vector<const Shape*> &foundItems) = 0;
 
         /**
          * @brief Searches the container for elements that are contained within the given bound.
          * @param bound The search bound that all the found elements should be contained in.
-         * @return A std::vector of std::list<Shape>::iterators, which point to the found elements. 
+         * @return A std::vector of pointers to the found elements, valid until the container is modified.
+         */
+        std::vector<const Shape*> queryContain(const qt::Bound &bound);
+
+        /**
+         * @brief Searches the container for elements that are contained within the given bound, into a caller-owned container.
+         * @param bound The search bound that all the found elements should be contained in.
+         * @param foundItems The pointers to the found elements are appended to it, they are valid until the container is modified.
          * @note Pure virtual (abstract) method, should be implemented.
          */
-        virtual std::vector<std::list<Shape>::iterator> queryContain(const qt::Bound &bound) = 0;
+        virtual void queryContain(const qt::Bound &bound, std::vector<const Shape*> &foundItems) = 0;
 
         /**
          * @brief Removes all elements from the container that overlap with the given bound.
@@ -87,18 +121,39 @@ class QuadTreeContainer : public ShapeContainer {
         void insert(const Shape &rectangle) override;                                           
 
         /**
-         * @brief Searches the container for elements that overlap with the given bound.
+         * @brief Insert a shape in the container, by moving it.
+         */
+        void insert(Shape &&rectangle) override;
+
+        /**
+         * @brief Insert several shapes in the container at once, with bulk loading if the container is empty.
+         */
+        void insert(const std::vector<Shape> &shapes) override;
+
+        /**
+         * @brief Insert several shapes in the container at once by moving them, with bulk loading if the container is empty.
+         */
+        void insert(std::vector<Shape> &&shapes) override;
+
+        /**
+         * @brief The returning variants of the queries, from the base class.
+         */
+        using ShapeContainer::queryOverlap;
+        using ShapeContainer::queryContain;
+
+        /**
+         * @brief Searches the container for elements that overlap with the given bound, into a caller-owned container.
          * @param bound The search bound that all the found elements should overlap with.
-         * @return A std::vector of std::list<Shape>::iterators, which point to the found elements.
+         * @param foundItems The pointers to the found elements are appended to it, they are valid until the container is modified.
          */
-        virtual std::vector<std::list<Shape>::iterator> queryOverlap(const qt::Bound &bound) override;
+        virtual void queryOverlap(const qt::Bound &bound, std::vector<const Shape*> &foundItems) override;
 
         /**
-         * @brief Searches the container for elements that are contained within the given bound.
+         * @brief Searches the container for elements that are contained within the given bound, into a caller-owned container.
          * @param bound The search bound that all the found elements should be contained in.
-         * @return A std::vector of std::list<Shape>::iterators, which point to the found elements. 
+         * @param foundItems The pointers to the found elements are appended to it, they are valid until the container is modified.
          */
-        virtual std::vector<std::list<Shape>::iterator> queryContain(const qt::Bound &bound) override;
+        virtual void queryContain(const qt::Bound &bound, std::vector<const Shape*> &foundItems) override;
 
         /**
          * @brief Removes all elements from the container that overlap with the given bound.
@@ -122,6 +177,86 @@ class QuadTreeContainer : public ShapeContainer {
          * @brief The qt::QuadTree<Shape>, as the underlying mechanism.
          */
         qt::QuadTree<Shape> itemContainer_qt;
+
+        /**
+         * @brief The traversal stacks of the removals, kept between the calls.
+         */
+        qt::QuadTree<Shape>::QueryScratch scratch_qt;
+};
+
+/**
+ * @brief Shape container class extending abstract ShapeContainer class,
+ *      with a qt::LinearQuadTree<Shape> as its underlying mechanism.
+ */
+class LinearQuadTreeContainer : public ShapeContainer {
+    public:
+        /**
+         * @brief Construct a LinearQuadTreeContainer with given bound.
+         */
+        LinearQuadTreeContainer(const qt::Bound &bound);
+
+        /**
+         * @brief Insert a shape in the container.
+         */
+        void insert(const Shape &rectangle) override;
+
+        /**
+         * @brief Insert a shape in the container, by moving it.
+         */
+        void insert(Shape &&rectangle) override;
+
+        /**
+         * @brief Insert several shapes in the container at once, from the base class.
+         */
+        using ShapeContainer::insert;
+
+        /**
+         * @brief The returning variants of the queries, from the base class.
+         */
+        using ShapeContainer::queryOverlap;
+        using ShapeContainer::queryContain;
+
+        /**
+         * @brief Searches the container for elements that overlap with the given bound, into a caller-owned container.
+         * @param bound The search bound that all the found elements should overlap with.
+         * @param foundItems The pointers to the found elements are appended to it, they are valid until the container is modified.
+         */
+        virtual void queryOverlap(const qt::Bound &bound, std::vector<const Shape*> &foundItems) override;
+
+        /**
+         * @brief Searches the container for elements that are contained within the given bound, into a caller-owned container.
+         * @param bound The search bound that all the found elements should be contained in.
+         * @param foundItems The pointers to the found elements are appended to it, they are valid until the container is modified.
+         */
+        virtual void queryContain(const qt::Bound &bound, std::vector<const Shape*> &foundItems) override;
+
+        /**
+         * @brief Removes all elements from the container that overlap with the given bound.
+         * @param bound The bound that all the removed elements should overlap with.
+         */
+        virtual void removeOverlap(const qt::Bound &bound) override;
+
+         /**
+         * @brief Removes all elements from the container that are fully contained within the given bound.
+         * @param bound The bound that contains all the elements that should be removed.
+         */
+        virtual void removeContain(const qt::Bound &bound) override;
+
+        /**
+         * @brief Returns all the boundaries that make up the inner structure of the container.
+         */
+        virtual std::vector<qt::Bound> getBounds() override;
+
+    protected:
+        /**
+         * @brief The qt::LinearQuadTree<Shape>, as the underlying mechanism.
+         */
+        qt::LinearQuadTree<Shape> itemContainer_lqt;
+
+        /**
+         * @brief The traversal stack of the removals, kept between the calls.
+         */
+        qt::LinearQuadTree<Shape>::QueryScratch scratch_lqt;
 };
 
 /**
@@ -141,18 +276,34 @@ class LinearContainer : public ShapeContainer {
         void insert(const Shape &rectangle) override;                                           
 
         /**
-         * @brief Searches the container for elements that overlap with the given bound.
+         * @brief Insert a shape in the container, by moving it.
+         */
+        void insert(Shape &&rectangle) override;
+
+        /**
+         * @brief Insert several shapes in the container at once, from the base class.
+         */
+        using ShapeContainer::insert;
+
+        /**
+         * @brief The returning variants of the queries, from the base class.
+         */
+        using ShapeContainer::queryOverlap;
+        using ShapeContainer::queryContain;
+
+        /**
+         * @brief Searches the container for elements that overlap with the given bound, into a caller-owned container.
          * @param bound The search bound that all the found elements should overlap with.
-         * @return A std::vector of std::list<Shape>::iterators, which point to the found elements.
+         * @param foundItems The pointers to the found elements are appended to it, they are valid until the container is modified.
          */
-        virtual std::vector<std::list<Shape>::iterator> queryOverlap(const qt::Bound &bound) override;
+        virtual void queryOverlap(const qt::Bound &bound, std::vector<const Shape*> &foundItems) override;
 
         /**
-         * @brief Searches the container for elements that are contained within the given bound.
+         * @brief Searches the container for elements that are contained within the given bound, into a caller-owned container.
          * @param bound The search bound that all the found elements should be contained in.
-         * @return A std::vector of std::list<Shape>::iterators, which point to the found elements. 
+         * @param foundItems The pointers to the found elements are appended to it, they are valid until the container is modified.
          */
-        virtual std::vector<std::list<Shape>::iterator> queryContain(const qt::Bound &bound) override;
+        virtual void queryContain(const qt::Bound &bound, std::vector<const Shape*> &foundItems) override;
 
         /**
          * @brief Removes all elements from the container that overlap with the given bound.
@@ -0,0 +1,955 @@
+/**
+ * Differential tests of the QuadTree and of the LinearQuadTree: every query and mutation path is compared against a linear scan
+ * over a plain list of the live elements (the model), on random data.
+ * Build and run it with "make test", it returns a non-zero exit code if any of the checks fails.
+ */
+#include "../lib/quadtree.hpp"      // qt::QuadTree
+#include "../lib/linear_quadtree.hpp" // qt::LinearQuadTree
+#include "../lib/region.hpp"        // qt::ConvexPolygon, qt::RegionRelation
+#include "../lib/bound.hpp"         // qt::Bound
+#include "../lib/util.hpp"          // qt::Vec2D_i32, qt::Vec2D_f64
+
+#include <vector>                   // std::vector
+#include <algorithm>                // std::sort, std::min, std::max
+#include <utility>                  // std::pair, std::move
+#include <mutex>                    // std::mutex, std::lock_guard
+#include <random>                   // std::mt19937
+#include <iterator>                 // std::make_move_iterator
+#include <cstdio>                   // std::printf
+#include <cmath>                    // std::cos, std::sin
+#include <limits>                   // std::numeric_limits
+#include <type_traits>              // std::is_trivially_copyable
+
+typedef qt::QuadTree<qt::Bound> Tree;
+typedef Tree::Handle Handle;
+typedef qt::LinearQuadTree<qt::Bound> LinearTree;
+
+/**
+ * The geometry kernel is evaluated at compile time, and a Bound is a plain value without a vtable.
+ */
+static_assert(std::is_trivially_copyable<qt::Bound>::value, "Bound must be trivially copyable.");
+static_assert(sizeof(qt::Bound) == 4 * sizeof(qt::int32_t), "Bound must hold its coordinates only.");
+static_assert(qt::Bound(qt::Vec2D_i32(0, 0), qt::Vec2D_i32(9, 9)).contains(qt::Bound(qt::Vec2D_i32(2, 2), qt::Vec2D_i32(9, 3))), "contains");
+static_assert(!qt::Bound(qt::Vec2D_i32(0, 0), qt::Vec2D_i32(9, 9)).overlaps(qt::Bound(qt::Vec2D_i32(10, 0), qt::Vec2D_i32(12, 9))), "overlaps");
+static_assert(qt::Bound(qt::Vec2D_i32(0, 0), qt::Vec2D_i32(9, 9)).getQuadDivision()[3].topLeft.x == 4, "getQuadDivision");
+static_assert(!qt::Bound(qt::Vec2D_i32(0, 0), qt::Vec2D_i32(0, 9)).quadDivisible(), "quadDivisible");
+
+/**
+ * @brief The number of failed checks.
+ */
+static int failCount = 0;
+
+/**
+ * @brief Reports the failure of a check, without stopping the tests.
+ */
+#define CHECK(condition) do { \
+        if(!(condition)) { \
+            failCount++; \
+            if(failCount <= 20) std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+        } \
+    } while(0)
+
+/**
+ * @brief The random number generator of the tests, with a fixed seed, so that a failure can be reproduced.
+ */
+static std::mt19937 rng(20240613);
+
+/**
+ * @brief Returns a random integer in [low, high].
+ */
+static int randomInt(int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(rng);
+}
+
+/**
+ * @brief Returns a random bound inside the world, mostly small, sometimes large.
+ */
+static qt::Bound randomBound(const qt::Bound &world, int maxSize) {
+    const int width = randomInt(0, randomInt(0, 19) == 0 ? maxSize * 10 : maxSize);
+    const int height = randomInt(0, randomInt(0, 19) == 0 ? maxSize * 10 : maxSize);
+    const int x = randomInt(world.topLeft.x, world.bottomRight.x), y = randomInt(world.topLeft.y, world.bottomRight.y);
+    return qt::Bound(qt::Vec2D_i32(x, y), qt::Vec2D_i32(std::min(x + width, world.bottomRight.x), std::min(y + height, world.bottomRight.y)));
+}
+
+/**
+ * @brief Returns a random bound that lies on (or across) a dividing line of a random node of the tree.
+ */
+static qt::Bound edgeBound(const qt::Bound &world) {
+    qt::Bound node = world;
+    for(int depth = randomInt(0, 6); depth > 0; depth--) {
+        node = node.getQuadDivision()[randomInt(0, 3)];
+    }
+
+    // On every axis the bound ends on the line, starts on it, crosses it, or is anywhere in the node
+    const qt::Vec2D_i32 middle = node.getQuadDivision()[0].bottomRight;
+    int sides[2][2];
+    for(int axis = 0; axis < 2; axis++) {
+        const int line = axis == 0 ? middle.x : middle.y, size = randomInt(0, 20);
+        const int low = axis == 0 ? node.topLeft.x : node.topLeft.y, high = axis == 0 ? node.bottomRight.x : node.bottomRight.y;
+        switch(randomInt(0, 3)) {
+            case 0: sides[axis][0] = std::max(low, line - size); sides[axis][1] = line; break;
+            case 1: sides[axis][0] = line; sides[axis][1] = std::min(high, line + size); break;
+            case 2: sides[axis][0] = std::max(low, line - size); sides[axis][1] = std::min(high, line + size); break;
+            default: sides[axis][0] = randomInt(low, high); sides[axis][1] = std::min(high, sides[axis][0] + size); break;
+        }
+    }
+    return qt::Bound(qt::Vec2D_i32(sides[0][0], sides[1][0]), qt::Vec2D_i32(sides[0][1], sides[1][1]));
+}
+
+/**
+ * @brief Compares two handles by their slot indices, to sort the results before comparing them.
+ */
+static bool handleLess(const Handle &a, const Handle &b) {
+    return a.index < b.index || (a.index == b.index && a.generation < b.generation);
+}
+
+/**
+ * @brief Sorts a result, so that it can be compared regardless of the order of the elements.
+ */
+static std::vector<Handle> sorted(std::vector<Handle> handles) {
+    std::sort(handles.begin(), handles.end(), handleLess);
+    return handles;
+}
+
+/**
+ * @brief Decides whether two results contain the same handles (in any order).
+ */
+static bool sameItems(const std::vector<Handle> &a, const std::vector<Handle> &b) {
+    return sorted(a) == sorted(b);
+}
+
+/**
+ * @brief The live elements of a QuadTree, as a plain list, and their expected bounds.
+ */
+struct Model {
+    std::vector<std::pair<Handle, qt::Bound>> items;
+
+    /**
+     * @brief Returns the handles of the elements whose bound satisfies the predicate, with a linear scan.
+     */
+    template <typename Predicate>
+    std::vector<Handle> select(Predicate predicateFn) const {
+        std::vector<Handle> found;
+        for(const auto &item : items) {
+            if(predicateFn(item.second)) {
+                found.push_back(item.first);
+            }
+        }
+        return found;
+    }
+
+    /**
+     * @brief Removes the elements whose bound satisfies the predicate.
+     */
+    template <typename Predicate>
+    void removeIf(Predicate predicateFn) {
+        items.erase(std::remove_if(items.begin(), items.end(), [&](const std::pair<Handle, qt::Bound> &item) {return predicateFn(item.second);}), items.end());
+    }
+
+    /**
+     * @brief Removes the element of the handle, and returns whether it was found.
+     */
+    bool erase(const Handle &handle) {
+        for(std::size_t i = 0; i < items.size(); i++) {
+            if(items[i].first == handle) {
+                items[i] = items.back();
+                items.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Returns the element of the handle, or nullptr if it isn't live.
+     */
+    std::pair<Handle, qt::Bound>* find(const Handle &handle) {
+        for(auto &item : items) {
+            if(item.first == handle) {
+                return &item;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * @brief Returns the pairs of overlapping elements of two lists (or of one list, for a self-join), each pair exactly once.
+ */
+static std::vector<std::pair<Handle, Handle>> overlappingPairs(const Model &modelA, const Model &modelB, bool selfJoin) {
+    // Sweep along the x axis: the elements are sorted by their left sides, and an element can only overlap
+    // with the ones that start before its right side (in a self-join, with the ones after it in the order)
+    std::vector<std::pair<Handle, qt::Bound>> a = modelA.items, b = modelB.items;
+    auto leftLess = [](const std::pair<Handle, qt::Bound> &x, const std::pair<Handle, qt::Bound> &y) {return x.second.topLeft.x < y.second.topLeft.x;};
+    std::sort(a.begin(), a.end(), leftLess);
+    std::sort(b.begin(), b.end(), leftLess);
+
+    std::vector<std::pair<Handle, Handle>> pairs;
+    for(std::size_t i = 0; i < a.size(); i++) {
+        for(std::size_t j = selfJoin ? i + 1 : 0; j < b.size(); j++) {
+            if(b[j].second.topLeft.x > a[i].second.bottomRight.x) {
+                break;
+            }
+            if(a[i].second.overlaps(b[j].second)) {
+                pairs.emplace_back(a[i].first, b[j].first);
+            }
+        }
+    }
+    return pairs;
+}
+
+/**
+ * @brief Brings a pair to a canonical form, so that unordered pairs can be compared.
+ */
+static std::pair<Handle, Handle> canonical(const std::pair<Handle, Handle> &pair) {
+    return handleLess(pair.second, pair.first) ? std::make_pair(pair.second, pair.first) : pair;
+}
+
+/**
+ * @brief Compares two lists of pairs regardless of their order (and of the order within the pairs, if unordered).
+ */
+static bool samePairs(std::vector<std::pair<Handle, Handle>> a, std::vector<std::pair<Handle, Handle>> b, bool unordered) {
+    auto pairLess = [](const std::pair<Handle, Handle> &x, const std::pair<Handle, Handle> &y) {
+        return handleLess(x.first, y.first) || (x.first == y.first && handleLess(x.second, y.second));
+    };
+    for(auto *pairs : {&a, &b}) {
+        if(unordered) {
+            for(auto &pair : *pairs) {
+                pair = canonical(pair);
+            }
+        }
+        std::sort(pairs->begin(), pairs->end(), pairLess);
+    }
+    return a == b;
+}
+
+/**
+ * @brief Checks that the stored bounds and the counts of the tree match the model.
+ */
+static void checkContent(const Tree &tree, const Model &model) {
+    CHECK(tree.size() == model.items.size());
+    for(const auto &item : model.items) {
+        CHECK(tree.contains(item.first));
+        if(tree.contains(item.first)) {
+            const qt::Bound &bound = tree[item.first];
+            CHECK(bound.topLeft.x == item.second.topLeft.x && bound.topLeft.y == item.second.topLeft.y
+                && bound.bottomRight.x == item.second.bottomRight.x && bound.bottomRight.y == item.second.bottomRight.y);
+        }
+    }
+}
+
+/**
+ * @brief Compares the single queries of the tree with the linear scan, for a random search bound.
+ */
+static void checkBoundQueries(const Tree &tree, const Model &model, const qt::Bound &query) {
+    auto overlapFn = [&](const qt::Bound &b) {return query.overlaps(b);};
+    auto containFn = [&](const qt::Bound &b) {return query.contains(b);};
+    const std::vector<Handle> overlapping = model.select(overlapFn), contained = model.select(containFn);
+
+    CHECK(sameItems(tree.queryOverlap(query), overlapping));
+    CHECK(sameItems(tree.queryContain(query), contained));
+
+    // The caller-owned containers keep their existing elements
+    std::vector<Handle> found(1, Handle{12345, 0});
+    tree.queryOverlap(query, found);
+    CHECK(found.size() == overlapping.size() + 1 && found[0] == (Handle{12345, 0}));
+
+    // The threaded overloads, with a single and with several threads
+    for(unsigned threadCount : {1u, 4u}) {
+        found.clear();
+        tree.queryOverlap(query, found, threadCount);
+        CHECK(sameItems(found, overlapping));
+        found.clear();
+        tree.queryContain(query, found, threadCount);
+        CHECK(sameItems(found, contained));
+    }
+
+    // The visitors, one by one and in ranges, and stopping them after the first element
+    found.clear();
+    tree.forEachOverlap(query, [&](const Handle &handle) {found.push_back(handle);});
+    CHECK(sameItems(found, overlapping));
+    found.clear();
+    tree.forEachContain(query, [&](const Handle &handle) {found.push_back(handle);});
+    CHECK(sameItems(found, contained));
+    found.clear();
+    tree.forEachOverlapRange(query, [&](const Handle *first, const Handle *last) {found.insert(found.end(), first, last);});
+    CHECK(sameItems(found, overlapping));
+    found.clear();
+    tree.forEachContainRange(query, [&](const Handle *first, const Handle *last) {found.insert(found.end(), first, last);});
+    CHECK(sameItems(found, contained));
+
+    std::size_t visitedCount = 0;
+    bool completed = tree.forEachOverlap(query, [&](const Handle&) {visitedCount++; return false;});
+    CHECK(completed == overlapping.empty() && visitedCount == std::min<std::size_t>(1, overlapping.size()));
+
+    CHECK(tree.countOverlap(query) == overlapping.size());
+    CHECK(tree.countContain(query) == contained.size());
+
+    auto customFn = [](const qt::Bound &b) {return (b.topLeft.x + b.topLeft.y) % 3 == 0;};
+    CHECK(sameItems(tree.queryIf(query, customFn), model.select([&](const qt::Bound &b) {return query.overlaps(b) && customFn(b);})));
+}
+
+/**
+ * @brief Compares the point, radius, nearest neighbour and ray queries of the tree with the linear scan.
+ */
+static void checkPointQueries(const Tree &tree, const Model &model, const qt::Vec2D_i32 &point, double radius) {
+    CHECK(sameItems(tree.queryPoint(point), model.select([&](const qt::Bound &b) {return b.contains(qt::Bound(point, point));})));
+
+    // The radius query, together with the distances
+    std::vector<Handle> found;
+    std::vector<int64_t> squaredDistances;
+    tree.queryRadius(point, radius, found, squaredDistances);
+    CHECK(sameItems(found, model.select([&](const qt::Bound &b) {return b.squaredDistance(point) <= radius * radius;})));
+    CHECK(found.size() == squaredDistances.size());
+    for(std::size_t i = 0; i < found.size() && i < squaredDistances.size(); i++) {
+        CHECK(tree[found[i]].squaredDistance(point) == squaredDistances[i]);
+    }
+
+    // The k nearest elements are ambiguous at equal distances, so the distances are compared
+    const std::size_t k = 10;
+    std::vector<int64_t> expectedDistances;
+    for(const auto &item : model.items) {
+        if(item.second.squaredDistance(point) <= radius * radius) {
+            expectedDistances.push_back(item.second.squaredDistance(point));
+        }
+    }
+    std::sort(expectedDistances.begin(), expectedDistances.end());
+    expectedDistances.resize(std::min(k, expectedDistances.size()));
+    std::vector<int64_t> nearestDistances;
+    for(const Handle &handle : tree.queryNearest(point, k, radius)) {
+        nearestDistances.push_back(tree[handle].squaredDistance(point));
+    }
+    CHECK(nearestDistances == expectedDistances);
+
+    // The ray hits every element that the linear scan finds, in the order of the entry points
+    const qt::Vec2D_f64 origin(point.x, point.y), direction(randomInt(-100, 100), randomInt(-100, 100));
+    const double maxT = randomInt(0, 1) ? 5.0 : std::numeric_limits<double>::infinity();
+    double entry = 0;
+    std::vector<Handle> hits = tree.queryRay(origin, direction, maxT);
+    CHECK(sameItems(hits, model.select([&](const qt::Bound &b) {return b.intersectsRay(origin, direction, maxT, entry);})));
+    double previousEntry = 0;
+    for(const Handle &handle : hits) {
+        tree[handle].intersectsRay(origin, direction, maxT, entry);
+        CHECK(entry >= previousEntry);
+        previousEntry = entry;
+    }
+}
+
+/**
+ * @brief Compares the region queries of the tree with the linear scan, for a random convex polygon.
+ */
+static void checkRegionQueries(const Tree &tree, const Model &model, const qt::Vec2D_i32 &center, int size) {
+    std::vector<qt::Vec2D_f64> vertices;
+    for(int i = 0; i < 6; i++) {
+        const double angle = i * 3.14159265358979 / 3 + randomInt(0, 30) / 100.0;
+        vertices.emplace_back(center.x + size * std::cos(angle), center.y + size * std::sin(angle));
+    }
+    const qt::ConvexPolygon polygon(vertices);
+    CHECK(sameItems(tree.queryRegionOverlap(polygon), model.select([&](const qt::Bound &b) {return polygon.classify(b) != qt::RegionRelation::OUTSIDE;})));
+    CHECK(sameItems(tree.queryRegionContain(polygon), model.select([&](const qt::Bound &b) {return polygon.classify(b) == qt::RegionRelation::INSIDE;})));
+}
+
+/**
+ * @brief Compares the batched queries (the CSR result) of the tree with the linear scan.
+ */
+static void checkBatchQueries(const Tree &tree, const Model &model, const std::vector<qt::Bound> &queries) {
+    Tree::QueryScratch scratch;
+    for(int variant = 0; variant < 4; variant++) {
+        Tree::BatchResult result;
+        switch(variant) {
+            case 0: tree.queryOverlapBatch(queries, result); break;
+            case 1: tree.queryOverlapBatch(queries, result, scratch); break;
+            case 2: tree.queryOverlapBatch(queries, result, 4u); break;
+            default: tree.queryOverlapBatch(queries, result, scratch, 3u); break;
+        }
+        CHECK(result.offsets.size() == queries.size() + 1);
+        if(result.offsets.size() != queries.size() + 1) {
+            continue;
+        }
+        CHECK(result.offsets.back() == result.items.size());
+        for(std::size_t q = 0; q < queries.size(); q++) {
+            std::vector<Handle> found(result.items.begin() + result.offsets[q], result.items.begin() + result.offsets[q + 1]);
+            CHECK(sameItems(found, model.select([&](const qt::Bound &b) {return queries[q].overlaps(b);})));
+        }
+    }
+}
+
+/**
+ * @brief Compares the self-join of the tree (sequential and threaded) with the sweep over the model.
+ */
+static void checkPairs(const Tree &tree, const Model &model) {
+    const std::vector<std::pair<Handle, Handle>> expected = overlappingPairs(model, model, true);
+
+    std::vector<std::pair<Handle, Handle>> found;
+    tree.forEachOverlappingPair([&](const Handle &a, const Handle &b) {found.emplace_back(a, b);});
+    CHECK(samePairs(found, expected, true));
+
+    std::mutex foundMutex;
+    found.clear();
+    tree.forEachOverlappingPair([&](const Handle &a, const Handle &b) {
+        std::lock_guard<std::mutex> lock(foundMutex);
+        found.emplace_back(a, b);
+    }, 4u);
+    CHECK(samePairs(found, expected, true));
+}
+
+/**
+ * @brief Compares all the queries of the tree with the linear scan, with unpacked and packed handles.
+ */
+static void checkQueries(Tree &tree, const Model &model, const qt::Bound &world, int queryCount) {
+    checkContent(tree, model);
+    for(int packed = 0; packed < 2; packed++) {
+        if(packed) {
+            tree.pack();
+            CHECK(tree.isPacked());
+        }
+        std::vector<qt::Bound> queries;
+        for(int i = 0; i < queryCount; i++) {
+            const qt::Bound query = randomBound(world, 300);
+            queries.push_back(query);
+            checkBoundQueries(tree, model, query);
+
+            const qt::Vec2D_i32 point(randomInt(world.topLeft.x, world.bottomRight.x), randomInt(world.topLeft.y, world.bottomRight.y));
+            checkPointQueries(tree, model, point, randomInt(0, 200));
+            checkRegionQueries(tree, model, point, randomInt(1, 600));
+        }
+        checkBoundQueries(tree, model, world);
+        checkBatchQueries(tree, model, queries);
+    }
+}
+
+/**
+ * @brief Tests the insertions, the queries and the removals by bound (sequential, with scratch, threaded, custom).
+ */
+static void testInsertQueryRemove(const qt::Bound &world) {
+    Tree tree(world);
+    Model model;
+    for(int i = 0; i < 30000; i++) {
+        const qt::Bound bound = randomBound(world, 40);
+        Handle handle;
+        switch(i % 3) {
+            case 0: handle = tree.insert(bound); break;
+            case 1: {qt::Bound copy = bound; handle = tree.insert(std::move(copy)); break;}
+            default: handle = tree.emplace(bound.topLeft, bound.bottomRight); break;
+        }
+        model.items.emplace_back(handle, bound);
+    }
+    checkQueries(tree, model, world, 30);
+    checkPairs(tree, model);
+
+    Tree::QueryScratch scratch;
+    for(int round = 0; round < 12; round++) {
+        const qt::Bound bound = randomBound(world, 1500);
+        auto overlapFn = [&](const qt::Bound &b) {return bound.overlaps(b);};
+        auto containFn = [&](const qt::Bound &b) {return bound.contains(b);};
+        auto customFn = [](const qt::Bound &b) {return b.topLeft.x % 2 == 0;};
+        switch(round % 7) {
+            case 0: tree.removeOverlap(bound); model.removeIf(overlapFn); break;
+            case 1: tree.removeContain(bound); model.removeIf(containFn); break;
+            case 2: tree.removeOverlap(bound, scratch); model.removeIf(overlapFn); break;
+            case 3: tree.removeContain(bound, scratch); model.removeIf(containFn); break;
+            case 4: tree.removeOverlap(bound, 4u); model.removeIf(overlapFn); break;
+            case 5: tree.removeContain(bound, 4u); model.removeIf(containFn); break;
+            default: tree.removeIf(bound, customFn); model.removeIf([&](const qt::Bound &b) {return bound.overlaps(b) && customFn(b);}); break;
+        }
+        checkQueries(tree, model, world, 3);
+    }
+    tree.removeOverlap(world, 4u);
+    model.items.clear();
+    checkQueries(tree, model, world, 2);
+}
+
+/**
+ * @brief Tests the single element mutations: updates (with a new value, or in place, also out of the tree bound and back)
+ *      and removals by handle.
+ */
+static void testUpdateErase(const qt::Bound &world) {
+    Tree tree(world);
+    Model model;
+    std::vector<Handle> handles;
+    const qt::Bound area(world.topLeft - qt::Vec2D_i32(300, 300), world.bottomRight + qt::Vec2D_i32(300, 300));
+    for(int i = 0; i < 20000; i++) {
+        const qt::Bound bound = randomBound(world, 40);
+        handles.push_back(tree.insert(bound));
+        model.items.emplace_back(handles.back(), bound);
+    }
+
+    for(int round = 0; round < 10; round++) {
+        for(int i = 0; i < 3000; i++) {
+            const Handle handle = handles[randomInt(0, int(handles.size()) - 1)];
+            auto *item = model.find(handle);
+            const int operation = randomInt(0, 3);
+            if(operation == 0) {
+                CHECK(tree.erase(handle) == (item != nullptr));
+                CHECK(!tree.contains(handle));
+                CHECK(!tree.erase(handle));
+                model.erase(handle);
+            } else if(operation == 1) {
+                // A small move, which usually stays in the same node
+                qt::Bound bound = item ? item->second : qt::Bound();
+                bound.topLeft.x = std::max(world.topLeft.x, bound.topLeft.x - 1);
+                bound.bottomRight.x = std::max(bound.topLeft.x, bound.bottomRight.x - 1);
+                CHECK(tree.update(handle, bound) == (item != nullptr));
+                if(item) {
+                    item->second = bound;
+                }
+            } else if(operation == 2) {
+                // A jump anywhere (sometimes out of the tree bound), modifying the element through operator[]
+                const qt::Bound bound = randomInt(0, 19) == 0 ? randomBound(area, 40) : randomBound(world, 40);
+                if(item) {
+                    tree[handle] = bound;
+                    item->second = bound;
+                }
+                CHECK(tree.update(handle) == (item != nullptr));
+            } else {
+                const qt::Bound bound = randomBound(world, 40);
+                handles.push_back(tree.insert(bound));
+                model.items.emplace_back(handles.back(), bound);
+            }
+        }
+        checkQueries(tree, model, world, 4);
+    }
+    checkPairs(tree, model);
+}
+
+/**
+ * @brief Tests the bulk loading against incremental insertion, with elements on the dividing lines and outside of the tree.
+ */
+static void testBuild(const qt::Bound &world) {
+    const qt::Bound area(world.topLeft - qt::Vec2D_i32(300, 300), world.bottomRight + qt::Vec2D_i32(300, 300));
+    std::vector<qt::Bound> bounds;
+    for(int i = 0; i < 20000; i++) {
+        switch(i % 4) {
+            case 0: bounds.push_back(randomBound(area, 40)); break;
+            case 1: bounds.push_back(edgeBound(world)); break;
+            default: bounds.push_back(randomBound(world, 40)); break;
+        }
+    }
+
+    // The same tree is built as by inserting the elements one by one (with the same handles)
+    Tree built(world, bounds.begin(), bounds.end()), inserted(world);
+    Model model;
+    std::vector<Handle> handles;
+    inserted.insert(bounds.begin(), bounds.end(), handles);
+    CHECK(handles.size() == bounds.size());
+    for(std::size_t i = 0; i < handles.size() && i < bounds.size(); i++) {
+        model.items.emplace_back(handles[i], bounds[i]);
+    }
+    // The node bounds of the two trees are compared as sorted coordinate lists
+    auto nodeCoordinates = [](const Tree &tree) {
+        std::vector<std::vector<int>> coordinates;
+        for(const qt::Bound &b : tree.getBounds()) {
+            coordinates.push_back({b.topLeft.x, b.topLeft.y, b.bottomRight.x, b.bottomRight.y});
+        }
+        std::sort(coordinates.begin(), coordinates.end());
+        return coordinates;
+    };
+    CHECK(nodeCoordinates(built) == nodeCoordinates(inserted));
+    checkQueries(built, model, world, 10);
+    checkQueries(inserted, model, world, 5);
+    checkBoundQueries(built, model, area);
+
+    // Building again replaces the content, and moves the elements of a move_iterator range
+    std::vector<qt::Bound> moved(bounds.begin(), bounds.begin() + 5000);
+    handles.clear();
+    built.build(std::make_move_iterator(moved.begin()), std::make_move_iterator(moved.end()), handles);
+    CHECK(handles.size() == 5000);
+    model.items.clear();
+    for(std::size_t i = 0; i < handles.size(); i++) {
+        model.items.emplace_back(handles[i], bounds[i]);
+    }
+    checkQueries(built, model, world, 5);
+
+    // And the tree keeps working with the usual mutations, also on the elements outside of it
+    for(int i = 0; i < 2000; i++) {
+        const qt::Bound bound = randomBound(world, 40);
+        model.items.emplace_back(built.insert(bound), bound);
+    }
+    for(std::size_t i = 0; i < handles.size(); i += 3) {
+        CHECK(built.erase(handles[i]));
+        model.erase(handles[i]);
+    }
+    const qt::Bound removed = randomBound(world, 1000);
+    built.removeOverlap(removed);
+    model.removeIf([&](const qt::Bound &b) {return removed.overlaps(b);});
+    checkQueries(built, model, world, 5);
+    checkBoundQueries(built, model, area);
+}
+
+/**
+ * @brief Tests the deferred mutation batches, against the same mutations applied one by one.
+ */
+static void testBatch(const qt::Bound &world) {
+    Tree tree(world);
+    Model model;
+    std::vector<Handle> handles;
+    for(int i = 0; i < 15000; i++) {
+        const qt::Bound bound = randomBound(world, 40);
+        handles.push_back(tree.insert(bound));
+        model.items.emplace_back(handles.back(), bound);
+    }
+
+    // Some elements are moved out of the tree bound (fully, or across its side) in a batch, and back in the next one
+    const qt::Bound area(world.topLeft - qt::Vec2D_i32(300, 300), world.bottomRight + qt::Vec2D_i32(300, 300));
+    const qt::Bound outsideArea(world.bottomRight + qt::Vec2D_i32(1, 1), area.bottomRight);
+    std::vector<Handle> movedOut;
+
+    Tree::Batch batch;
+    for(int round = 0; round < 10; round++) {
+        std::vector<qt::Bound> inserted;
+        for(int i = 0; i < 2000; i++) {
+            const Handle handle = handles[randomInt(0, int(handles.size()) - 1)];
+            const qt::Bound bound = randomBound(world, 40);
+            switch(randomInt(0, 3)) {
+                case 0: batch.erase(handle); model.erase(handle); break;
+                case 1: {
+                    // Several updates of the same element, the last one counts (unless it is removed in the same batch)
+                    batch.update(handle, randomBound(world, 40));
+                    batch.update(handle, bound);
+                    auto *item = model.find(handle);
+                    if(item) {
+                        item->second = bound;
+                    }
+                    break;
+                }
+                case 2: batch.insert(bound); inserted.push_back(bound); break;
+                default: batch.emplace(bound.topLeft, bound.bottomRight); inserted.push_back(bound); break;
+            }
+        }
+        auto moveTo = [&](const Handle &handle, const qt::Bound &bound) {
+            batch.update(handle, bound);
+            auto *item = model.find(handle);
+            if(item) {
+                item->second = bound;
+            }
+        };
+        for(const Handle &handle : movedOut) {
+            moveTo(handle, randomBound(world, 40));
+        }
+        movedOut.clear();
+        for(int i = 0; i < 100; i++) {
+            movedOut.push_back(handles[randomInt(0, int(handles.size()) - 1)]);
+            moveTo(movedOut.back(), i % 2 == 0 ? randomBound(outsideArea, 40)
+                : qt::Bound(world.bottomRight - qt::Vec2D_i32(10, 10), world.bottomRight + qt::Vec2D_i32(randomInt(1, 100), randomInt(1, 100))));
+        }
+
+        // The removals are applied first, so an element that is updated and removed in the same batch is removed
+        const Handle updatedAndErased = model.items[0].first;
+        batch.update(updatedAndErased, world);
+        batch.erase(updatedAndErased);
+        model.erase(updatedAndErased);
+
+        // Nothing changes until the batch is applied
+        const std::size_t sizeBefore = tree.size();
+        CHECK(!batch.empty());
+        CHECK(tree.size() == sizeBefore);
+
+        std::vector<Handle> insertedHandles;
+        tree.apply(batch, insertedHandles);
+        CHECK(batch.empty());
+        CHECK(insertedHandles.size() == inserted.size());
+        for(std::size_t i = 0; i < insertedHandles.size() && i < inserted.size(); i++) {
+            model.items.emplace_back(insertedHandles[i], inserted[i]);
+            handles.push_back(insertedHandles[i]);
+        }
+        checkQueries(tree, model, world, 4);
+        checkBoundQueries(tree, model, area);
+    }
+    checkPairs(tree, model);
+}
+
+/**
+ * @brief Tests the generational handles: the handles of the removed elements become invalid,
+ *      even if their slots are reused by new elements.
+ */
+static void testHandles(const qt::Bound &world) {
+    Tree tree(world);
+    Model model;
+    std::vector<Handle> removed;
+    for(int round = 0; round < 5; round++) {
+        for(int i = 0; i < 2000; i++) {
+            const qt::Bound bound = randomBound(world, 40);
+            model.items.emplace_back(tree.insert(bound), bound);
+        }
+        const qt::Bound bound = randomBound(world, 2000);
+        for(const Handle &handle : model.select([&](const qt::Bound &b) {return bound.overlaps(b);})) {
+            removed.push_back(handle);
+        }
+        tree.removeOverlap(bound);
+        model.removeIf([&](const qt::Bound &b) {return bound.overlaps(b);});
+
+        for(const Handle &handle : removed) {
+            CHECK(!tree.contains(handle));
+        }
+        checkQueries(tree, model, world, 5);
+    }
+}
+
+/**
+ * @brief Tests the clearing of the tree: all the nodes are released at once, and the tree can be filled again.
+ */
+static void testClear(const qt::Bound &world) {
+    Tree tree(world);
+    Model model;
+    for(int round = 0; round < 3; round++) {
+        std::vector<Handle> cleared;
+        for(int i = 0; i < 10000; i++) {
+            const qt::Bound bound = randomBound(world, 40);
+            cleared.push_back(tree.insert(bound));
+        }
+        CHECK(tree.getBounds().size() > 1);
+
+        tree.clear();
+        CHECK(tree.size() == 0);
+        CHECK(tree.getBounds().size() == 1);
+        for(const Handle &handle : cleared) {
+            CHECK(!tree.contains(handle));
+        }
+        checkQueries(tree, model, world, 3);
+    }
+
+    // The nodes are allocated again from the kept memory of the arena
+    for(int i = 0; i < 10000; i++) {
+        const qt::Bound bound = randomBound(world, 40);
+        model.items.emplace_back(tree.insert(bound), bound);
+    }
+    checkQueries(tree, model, world, 10);
+}
+
+/**
+ * @brief Tests the spatial join of two trees with different bounds against the sweep over the models.
+ */
+static void testSpatialJoin(const qt::Bound &world) {
+    const qt::Bound otherWorld(world.topLeft + qt::Vec2D_i32(700, 300), world.bottomRight + qt::Vec2D_i32(900, 1200));
+    Tree treeA(world), treeB(otherWorld);
+    Model modelA, modelB;
+    for(int i = 0; i < 12000; i++) {
+        const qt::Bound boundA = randomBound(world, 40), boundB = randomBound(otherWorld, 40);
+        modelA.items.emplace_back(treeA.insert(boundA), boundA);
+        modelB.items.emplace_back(treeB.insert(boundB), boundB);
+    }
+
+    const std::vector<std::pair<Handle, Handle>> expected = overlappingPairs(modelA, modelB, false);
+    CHECK(!expected.empty());
+
+    std::vector<std::pair<Handle, Handle>> found;
+    CHECK(Tree::spatialJoin(treeA, treeB, [&](const Handle &a, const Handle &b) {found.emplace_back(a, b);}));
+    CHECK(samePairs(found, expected, false));
+
+    // Stopping after the first pair
+    std::size_t pairCount = 0;
+    CHECK(!Tree::spatialJoin(treeA, treeB, [&](const Handle&, const Handle&) {pairCount++; return false;}) || expected.empty());
+    CHECK(pairCount == std::min<std::size_t>(1, expected.size()));
+}
+
+/**
+ * @brief Tests the queries and the removals of the elements that are outside of the bound of the tree (they are stored in the root).
+ * @note The search bounds are taken from the area around the tree, so some of them cover the whole tree.
+ */
+static void testOutsideRoot(const qt::Bound &world) {
+    Tree tree(world);
+    Model model;
+    const qt::Bound area(world.topLeft - qt::Vec2D_i32(300, 300), world.bottomRight + qt::Vec2D_i32(300, 300));
+    for(int i = 0; i < 12000; i++) {
+        // Some of the elements are partially or fully outside of the tree
+        const qt::Bound bound = i % 20 == 0 ? randomBound(area, 40) : randomBound(world, 40);
+        model.items.emplace_back(tree.insert(bound), bound);
+    }
+
+    Model otherModel;
+    Tree otherTree(qt::Bound(world.topLeft + qt::Vec2D_i32(500, 500), world.bottomRight + qt::Vec2D_i32(500, 500)));
+    for(int i = 0; i < 3000; i++) {
+        const qt::Bound bound = randomBound(area, 40);
+        otherModel.items.emplace_back(otherTree.insert(bound), bound);
+    }
+
+    for(int packed = 0; packed < 2; packed++) {
+        if(packed) {
+            tree.pack();
+        }
+        std::vector<qt::Bound> queries{world, area};
+        for(int i = 0; i < 100; i++) {
+            const qt::Bound query = randomBound(area, 300);
+            queries.push_back(query);
+            checkBoundQueries(tree, model, query);
+
+            const qt::Vec2D_i32 point(randomInt(area.topLeft.x, area.bottomRight.x), randomInt(area.topLeft.y, area.bottomRight.y));
+            checkPointQueries(tree, model, point, randomInt(0, 200));
+            checkRegionQueries(tree, model, point, randomInt(1, 300));
+        }
+        checkBoundQueries(tree, model, world);
+        checkBoundQueries(tree, model, area);
+        checkBatchQueries(tree, model, queries);
+
+        // A region around the whole tree, that leaves out some of the elements outside of it (near the corners)
+        checkRegionQueries(tree, model, qt::Vec2D_i32((world.topLeft.x + world.bottomRight.x) / 2, (world.topLeft.y + world.bottomRight.y) / 2), 3400);
+    }
+
+    checkPairs(tree, model);
+
+    std::vector<std::pair<Handle, Handle>> found;
+    Tree::spatialJoin(tree, otherTree, [&](const Handle &a, const Handle &b) {found.emplace_back(a, b);});
+    CHECK(samePairs(found, overlappingPairs(model, otherModel, false), false));
+
+    // The removals reach the elements outside of the tree, even with a bound that misses the tree
+    const qt::Bound corner(area.topLeft, world.topLeft - qt::Vec2D_i32(1, 1));
+    tree.removeOverlap(corner, 4u);
+    model.removeIf([&](const qt::Bound &b) {return corner.overlaps(b);});
+    checkContent(tree, model);
+
+    // Covering the whole tree removes only the elements that are inside of the bound, not the ones outside of it
+    tree.removeContain(world);
+    model.removeIf([&](const qt::Bound &b) {return world.contains(b);});
+    CHECK(!model.items.empty());
+    checkContent(tree, model);
+    checkBoundQueries(tree, model, area);
+
+    // A single element far outside of the tree
+    Tree smallTree(qt::Bound(qt::Vec2D_i32(0, 0), qt::Vec2D_i32(99, 99)));
+    const Handle outside = smallTree.insert(qt::Bound(qt::Vec2D_i32(150, 150), qt::Vec2D_i32(160, 160)));
+    smallTree.pack();
+    CHECK(smallTree.queryOverlap(qt::Bound(qt::Vec2D_i32(155, 155), qt::Vec2D_i32(155, 155))).size() == 1);
+    CHECK(smallTree.queryOverlap(qt::Bound(qt::Vec2D_i32(0, 0), qt::Vec2D_i32(99, 99))).empty());
+    CHECK(smallTree.queryPoint(qt::Vec2D_i32(155, 155)) == std::vector<Handle>(1, outside));
+    CHECK(smallTree.queryPoint(qt::Vec2D_i32(50, 50)).empty());
+    CHECK(smallTree.queryNearest(qt::Vec2D_i32(50, 50), 1, 200).size() == 1);
+    CHECK(smallTree.queryRadius(qt::Vec2D_i32(170, 170), 20) == std::vector<Handle>(1, outside));
+    CHECK(smallTree.queryRay(qt::Vec2D_f64(155, 0), qt::Vec2D_f64(0, 1)) == std::vector<Handle>(1, outside));
+}
+
+/**
+ * @brief Compares the queries of the LinearQuadTree with the linear scan, for a random search bound.
+ */
+static void checkLinearQueries(const LinearTree &tree, const Model &model, const qt::Bound &query) {
+    auto overlapFn = [&](const qt::Bound &b) {return query.overlaps(b);};
+    auto containFn = [&](const qt::Bound &b) {return query.contains(b);};
+    const std::vector<Handle> overlapping = model.select(overlapFn), contained = model.select(containFn);
+
+    CHECK(sameItems(tree.queryOverlap(query), overlapping));
+    CHECK(sameItems(tree.queryContain(query), contained));
+
+    std::vector<Handle> found(1, Handle{12345, 0});
+    tree.queryOverlap(query, found);
+    CHECK(found.size() == overlapping.size() + 1 && found[0] == (Handle{12345, 0}));
+
+    found.clear();
+    tree.forEachOverlap(query, [&](const Handle &handle) {found.push_back(handle);});
+    CHECK(sameItems(found, overlapping));
+    found.clear();
+    tree.forEachContain(query, [&](const Handle &handle) {found.push_back(handle);});
+    CHECK(sameItems(found, contained));
+    found.clear();
+    tree.forEachOverlapRange(query, [&](const Handle *first, const Handle *last) {found.insert(found.end(), first, last);});
+    CHECK(sameItems(found, overlapping));
+    found.clear();
+    tree.forEachContainRange(query, [&](const Handle *first, const Handle *last) {found.insert(found.end(), first, last);});
+    CHECK(sameItems(found, contained));
+
+    std::size_t visitedCount = 0;
+    bool completed = tree.forEachContain(query, [&](const Handle&) {visitedCount++; return false;});
+    CHECK(completed == contained.empty() && visitedCount == std::min<std::size_t>(1, contained.size()));
+}
+
+/**
+ * @brief Checks the content of the LinearQuadTree, and compares its queries with the linear scan.
+ * @note The search bounds are taken from the area around the tree, so some of them cover the whole tree.
+ */
+static void checkLinearTree(const LinearTree &tree, const Model &model, const qt::Bound &world, const qt::Bound &area, int queryCount) {
+    CHECK(tree.size() == model.items.size());
+    for(const auto &item : model.items) {
+        CHECK(tree.contains(item.first));
+        if(tree.contains(item.first)) {
+            const qt::Bound &bound = tree[item.first];
+            CHECK(bound.topLeft.x == item.second.topLeft.x && bound.topLeft.y == item.second.topLeft.y
+                && bound.bottomRight.x == item.second.bottomRight.x && bound.bottomRight.y == item.second.bottomRight.y);
+        }
+    }
+
+    for(int i = 0; i < queryCount; i++) {
+        checkLinearQueries(tree, model, randomBound(area, 300));
+    }
+    checkLinearQueries(tree, model, world);
+    checkLinearQueries(tree, model, area);
+}
+
+/**
+ * @brief Tests the insertions, the queries and the removals of the LinearQuadTree, with sorted and unsorted elements.
+ */
+static void testLinearQuadTree(const qt::Bound &world) {
+    LinearTree tree(world);
+    Model model;
+    const qt::Bound area(world.topLeft - qt::Vec2D_i32(300, 300), world.bottomRight + qt::Vec2D_i32(300, 300));
+    auto insertRandom = [&](int count) {
+        for(int i = 0; i < count; i++) {
+            // Some of the elements are partially or fully outside of the tree
+            const qt::Bound bound = i % 20 == 0 ? randomBound(area, 40) : randomBound(world, 40);
+            Handle handle;
+            switch(i % 3) {
+                case 0: handle = tree.insert(bound); break;
+                case 1: {qt::Bound copy = bound; handle = tree.insert(std::move(copy)); break;}
+                default: handle = tree.emplace(bound.topLeft, bound.bottomRight); break;
+            }
+            model.items.emplace_back(handle, bound);
+        }
+    };
+
+    insertRandom(20000);
+    checkLinearTree(tree, model, world, area, 30);
+    tree.pack();
+    CHECK(tree.isPacked());
+    checkLinearTree(tree, model, world, area, 30);
+
+    // Removals, mixed with insertions, so that the levels have sorted and unsorted elements too
+    LinearTree::QueryScratch scratch;
+    for(int round = 0; round < 12; round++) {
+        insertRandom(1000);
+        CHECK(!tree.isPacked());
+        if(round % 3 == 0) {
+            tree.pack();
+        }
+
+        const qt::Bound bound = randomBound(world, 1500);
+        switch(round % 4) {
+            case 0: tree.removeOverlap(bound); model.removeIf([&](const qt::Bound &b) {return bound.overlaps(b);}); break;
+            case 1: tree.removeContain(bound); model.removeIf([&](const qt::Bound &b) {return bound.contains(b);}); break;
+            case 2: tree.removeOverlap(bound, scratch); model.removeIf([&](const qt::Bound &b) {return bound.overlaps(b);}); break;
+            default: tree.removeContain(bound, scratch); model.removeIf([&](const qt::Bound &b) {return bound.contains(b);}); break;
+        }
+        checkLinearTree(tree, model, world, area, 5);
+    }
+    CHECK(!tree.getBounds().empty());
+
+    // Covering the whole tree removes only the elements that are inside of the bound, not the ones outside of it
+    tree.removeContain(world);
+    model.removeIf([&](const qt::Bound &b) {return world.contains(b);});
+    CHECK(!model.items.empty());
+    checkLinearTree(tree, model, world, area, 5);
+
+    tree.removeOverlap(area);
+    model.items.clear();
+    checkLinearTree(tree, model, world, area, 2);
+    CHECK(tree.isPacked());
+
+    tree.clear();
+    CHECK(tree.size() == 0 && tree.getBounds().size() == 1);
+}
+
+int main() {
+    const qt::Bound world(qt::Vec2D_i32(0, 0), qt::Vec2D_i32(4095, 4095));
+    testInsertQueryRemove(world);
+    testUpdateErase(world);
+    testBuild(world);
+    testBatch(world);
+    testHandles(world);
+    testClear(world);
+    testSpatialJoin(world);
+    testOutsideRoot(world);
+    testLinearQuadTree(world);
+
+    if(failCount > 0) {
+        std::printf("%d check(s) failed\n", failCount);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
@@ -1,14 +1,17 @@
 #ifndef BOUND_H
 #define BOUND_H
 
-#include "util.hpp"     // qt::Vec2D_i32
+#include "util.hpp"     // qt::Vec2D_i32, qt::Vec2D_f64, qt::int64_t
 #include <array>        // std::array
+#include <type_traits>  // std::is_trivially_copyable
 
 namespace qt {
     /**
      * @brief Stores two coordinates by which the boundaries of a 2D rectangle can be described.
      * @note It uses integral signed fixed size (32 bit) type for storing the coordinates,
      *      as it uses the Vec2D_i32 struct from the utilities library (for which the + and - operations are also defined). 
+     * @note It has no virtual methods, so it is trivially copyable and holds only the two points. All the methods
+     *      are constexpr and defined in this header, so they can be inlined into the loops of the trees.
      */
     class Bound {
         public:
@@ -22,12 +25,12 @@ namespace qt {
             /**
              * @brief Default constructor, initializes the boundary with {0, 0} coordinates on both points.
              */
-            Bound();                                            
+            constexpr Bound() noexcept;
 
             /**
              * @brief Parameter constructor, constructs the bound with the two given points.
              */
-            Bound(const Vec2D_i32 &topLeft, const Vec2D_i32 &bottomRight);
+            constexpr Bound(const Vec2D_i32 &topLeft, const Vec2D_i32 &bottomRight) noexcept;
 
             /**
              * @brief Decides wether the boundary overlaps PARTIALLY of FULLY with another boundary.
@@ -35,28 +38,136 @@ namespace qt {
              * @return true if the bound overlaps the other, false otherwise.
              * @note If the two bounds overlap only on a side, it is considered an overlap.
              */
-            virtual bool overlaps(const Bound &other) const;
+            constexpr bool overlaps(const Bound &other) const noexcept;
 
             /**
              * @brief Decides wether the boundary FULLY contains another boundary.
              * @param other The boundary that it needs to be checked against.
              * @return true if the bound fully covers the other, false otherwise.
              */
-            virtual bool contains(const Bound &other) const;
+            constexpr bool contains(const Bound &other) const noexcept;
+
+            /**
+             * @brief Calculates the squared distance between the boundary and a point.
+             * @param point The point that it needs to be checked against.
+             * @return 0 if the point is within the boundary, the squared distance of the closest point of the boundary otherwise.
+             * @note It is squared so that it stays exact, and it compares the same way as the distance itself.
+             */
+            constexpr int64_t squaredDistance(const Vec2D_i32 &point) const noexcept;
+
+            /**
+             * @brief Decides wether a ray hits the boundary, using the slab test (clipping the ray to both axis-aligned slabs).
+             * @param origin The starting point of the ray.
+             * @param direction The direction of the ray, the points of the ray are origin + t * direction, for 0 <= t <= maxT.
+             * @param maxT The end of the ray (infinity for an unbounded ray, 1 for the segment from origin to origin + direction).
+             * @param entry Receives the smallest t at which the ray is within the boundary (0 if it starts inside).
+             * @return true if the ray hits the boundary, false otherwise.
+             * @note The boundary is closed, so touching a side is considered a hit.
+             */
+            constexpr bool intersectsRay(const Vec2D_f64 &origin, const Vec2D_f64 &direction, double maxT, double &entry) const noexcept;
 
             /**
              * @brief Splits the boundary in four equal boundaries (quadrons).
              * @return A std::array of qt::Bounds with 4 elements, the 4 quadrons of the bound,
              *      in the following order: NW, NE, SW, SE.
              */
-            virtual std::array<Bound, 4> getQuadDivision() const;
+            constexpr std::array<Bound, 4> getQuadDivision() const noexcept;
 
             /**
              * @brief Decides wether the bound is big enough to be divided in four.
              * @return true if the bound can be divided in four, false otherwise.
              */
-            virtual bool quadDivisible() const;                             
+            constexpr bool quadDivisible() const noexcept;
     };
+
+    /**
+     * Make sure that no virtual method (and vptr) sneaks back into the Bound.
+     */
+    static_assert(std::is_trivially_copyable<Bound>::value, "Bound must be trivially copyable.");
+
+    /*------------------------------------------------
+                Bound class implementation
+    --------------------------------------------------*/
+
+    // Default constructor, initializes the boundary with {0, 0} coordinates on both points.
+    constexpr Bound::Bound() noexcept : Bound(Vec2D_i32(0, 0), Vec2D_i32(0, 0)) {}
+
+    // Parameter constructor, constructs the bound with the two given points.
+    constexpr Bound::Bound(const Vec2D_i32 &topLeft, const Vec2D_i32 &bottomRight) noexcept : topLeft(topLeft), bottomRight(bottomRight) {}
+
+    // Decides wether the boundary overlaps PARTIALLY of FULLY with another boundary.
+    constexpr bool Bound::overlaps(const Bound &other) const noexcept {
+        return this->topLeft.x <= other.bottomRight.x
+            && this->bottomRight.x >= other.topLeft.x
+            && this->topLeft.y <= other.bottomRight.y
+            && this->bottomRight.y >= other.topLeft.y;
+    }
+
+    // Decides wether the boundary FULLY contains another boundary.
+    constexpr bool Bound::contains(const Bound &other) const noexcept {
+        return this->topLeft.x <= other.topLeft.x
+            && this->topLeft.y <= other.topLeft.y
+            && this->bottomRight.x >= other.bottomRight.x
+            && this->bottomRight.y >= other.bottomRight.y;
+    }
+
+    // Calculates the squared distance between the boundary and a point.
+    constexpr int64_t Bound::squaredDistance(const Vec2D_i32 &point) const noexcept {
+        // The distance on each axis is 0 if the point is between the sides, otherwise it is the distance from the nearer side
+        int64_t dx = point.x < topLeft.x ? int64_t(topLeft.x) - point.x : (point.x > bottomRight.x ? int64_t(point.x) - bottomRight.x : 0);
+        int64_t dy = point.y < topLeft.y ? int64_t(topLeft.y) - point.y : (point.y > bottomRight.y ? int64_t(point.y) - bottomRight.y : 0);
+        return dx * dx + dy * dy;
+    }
+
+    // Decides wether a ray hits the boundary, using the slab test.
+    constexpr bool Bound::intersectsRay(const Vec2D_f64 &origin, const Vec2D_f64 &direction, double maxT, double &entry) const noexcept {
+        const double from[2] = {origin.x, origin.y}, step[2] = {direction.x, direction.y};
+        const double low[2] = {double(topLeft.x), double(topLeft.y)}, high[2] = {double(bottomRight.x), double(bottomRight.y)};
+
+        // The part [tNear, tFar] of the ray that is within both slabs
+        double tNear = 0, tFar = maxT;
+        for(int axis = 0; axis < 2; axis++) {
+            // A ray parallel with the slab is either always or never within it
+            if(step[axis] == 0) {
+                if(from[axis] < low[axis] || from[axis] > high[axis]) {
+                    return false;
+                }
+                continue;
+            }
+
+            double t1 = (low[axis] - from[axis]) / step[axis], t2 = (high[axis] - from[axis]) / step[axis];
+            if(t1 > t2) {
+                double t = t1; t1 = t2; t2 = t;
+            }
+            tNear = t1 > tNear ? t1 : tNear;
+            tFar = t2 < tFar ? t2 : tFar;
+            if(tNear > tFar) {
+                return false;
+            }
+        }
+
+        entry = tNear;
+        return true;
+    }
+
+    // Splits the boundary in four equal boundaries (quadrons).
+    constexpr std::array<Bound, 4> Bound::getQuadDivision() const noexcept {
+        Vec2D_i32 halfSize = Vec2D_i32((bottomRight.x - topLeft.x) / 2, (bottomRight.y - topLeft.y) / 2);
+
+        // Order: NW, NE, SW, SE
+        return {{
+            Bound(topLeft, topLeft + halfSize),
+            Bound(Vec2D_i32(topLeft.x + halfSize.x, topLeft.y), Vec2D_i32(bottomRight.x, topLeft.y + halfSize.y)),
+            Bound(Vec2D_i32(topLeft.x, topLeft.y + halfSize.y), Vec2D_i32(topLeft.x + halfSize.x, bottomRight.y)),
+            Bound(topLeft + halfSize, bottomRight)
+        }};
+    }
+
+    // Decides wether the bound is big enough to be divided in four.
+    constexpr bool Bound::quadDivisible() const noexcept {
+        // If the two endpoints lie on the same line, the bound can't be divided in four.
+        return (topLeft.x < bottomRight.x) && (topLeft.y < bottomRight.y);
+    }
 }
 
 #endif
\ No newline at end of file
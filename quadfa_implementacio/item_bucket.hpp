@@ -0,0 +1,103 @@
+#ifndef ITEM_BUCKET_H
+#define ITEM_BUCKET_H
+
+#include "bound.hpp"        // qt::Bound
+#include "util.hpp"         // qt::int32_t
+
+#include <vector>           // std::vector
+#include <cstddef>          // std::size_t
+
+namespace qt {
+    /**
+     * @brief The items of a tree node: their handles, together with a copy of their bounds,
+     *      stored in structure-of-arrays form.
+     * @tparam H The type of the handles that identify the items in the outer container.
+     * @note The spatial filtering of a node reads only the contiguous coordinate arrays,
+     *      the outer container (the item itself) is only touched for the items that match.
+     */
+    template <typename H>
+    struct ItemBucket {
+        /**
+         * @brief The coordinates of the bounds of the items, the i-th entry of each array belongs to the i-th item.
+         */
+        std::vector<int32_t> minX;
+        std::vector<int32_t> minY;
+        std::vector<int32_t> maxX;
+        std::vector<int32_t> maxY;
+
+        /**
+         * @brief The handles of the items.
+         */
+        std::vector<H> handles;
+
+        /**
+         * @brief Appends an item to the bucket.
+         * @param[in] handle The handle of the item.
+         * @param[in] bound The bound of the item.
+         */
+        void push_back(const H &handle, const Bound &bound);
+
+        /**
+         * @brief Reserves memory for the given number of items.
+         */
+        void reserve(std::size_t capacity);
+
+        /**
+         * @brief Reconstructs the bound of the i-th item.
+         */
+        Bound getBound(std::size_t i) const;
+
+        /**
+         * @brief Overwrites the bound of the i-th item.
+         */
+        void setBound(std::size_t i, const Bound &bound);
+
+        /**
+         * @brief Removes the i-th item in constant time, by moving the last item in its place.
+         */
+        void erase(std::size_t i);
+
+        /**
+         * @brief Removes all the items for which the predicate is true, keeping the order of the others.
+         * @param[in] predicateFn Unary predicate, taking the bound of an item.
+         * @param[in] removedFn Callback, called with the handle of each removed item.
+         */
+        template <typename Predicate, typename Callback>
+        void removeIf(Predicate predicateFn, Callback removedFn);
+
+        /**
+         * @brief Removes all the items for which the predicate is true, keeping the order of the others.
+         * @param[in] predicateFn Unary predicate, taking the bound of an item.
+         * @param[in] removedFn Callback, called with the handle of each removed item.
+         * @param[in] movedFn Callback, called with the handle and the new index of each kept item whose index has changed.
+         */
+        template <typename Predicate, typename Callback, typename MovedCallback>
+        void removeIf(Predicate predicateFn, Callback removedFn, MovedCallback movedFn);
+
+        /**
+         * @brief Removes the items from the given index on, keeping the first ones.
+         * @param[in] count The number of items that remain in the bucket, at most size().
+         */
+        void truncate(std::size_t count);
+
+        /**
+         * @brief Returns the number of items in the bucket.
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief Decides whether the bucket has no items.
+         */
+        bool empty() const;
+
+        /**
+         * @brief Removes all the items from the bucket.
+         */
+        void clear();
+    };
+}
+
+// The template definitions, so that the class can be used header-only, without explicit instantiation
+#include "item_bucket.tpp"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "item_bucket.hpp"      // class declarations
+
+namespace qt {
+    /*------------------------------------------------
+          ItemBucket template class implementation
+    --------------------------------------------------*/
+
+    // Appends an item to the bucket.
+    template <typename H>
+    void ItemBucket<H>::push_back(const H &handle, const Bound &bound) {
+        minX.push_back(bound.topLeft.x);
+        minY.push_back(bound.topLeft.y);
+        maxX.push_back(bound.bottomRight.x);
+        maxY.push_back(bound.bottomRight.y);
+        handles.push_back(handle);
+    }
+
+    // Reserves memory for the given number of items.
+    template <typename H>
+    void ItemBucket<H>::reserve(std::size_t capacity) {
+        minX.reserve(capacity);
+        minY.reserve(capacity);
+        maxX.reserve(capacity);
+        maxY.reserve(capacity);
+        handles.reserve(capacity);
+    }
+
+    // Reconstructs the bound of the i-th item.
+    template <typename H>
+    Bound ItemBucket<H>::getBound(std::size_t i) const {
+        return Bound(Vec2D_i32(minX[i], minY[i]), Vec2D_i32(maxX[i], maxY[i]));
+    }
+
+    // Overwrites the bound of the i-th item.
+    template <typename H>
+    void ItemBucket<H>::setBound(std::size_t i, const Bound &bound) {
+        minX[i] = bound.topLeft.x;
+        minY[i] = bound.topLeft.y;
+        maxX[i] = bound.bottomRight.x;
+        maxY[i] = bound.bottomRight.y;
+    }
+
+    // Removes the i-th item in constant time, by moving the last item in its place.
+    template <typename H>
+    void ItemBucket<H>::erase(std::size_t i) {
+        minX[i] = minX.back();
+        minY[i] = minY.back();
+        maxX[i] = maxX.back();
+        maxY[i] = maxY.back();
+        handles[i] = handles.back();
+
+        minX.pop_back();
+        minY.pop_back();
+        maxX.pop_back();
+        maxY.pop_back();
+        handles.pop_back();
+    }
+
+    // Removes all the items for which the predicate is true, keeping the order of the others.
+    template <typename H>
+    template <typename Predicate, typename Callback>
+    void ItemBucket<H>::removeIf(Predicate predicateFn, Callback removedFn) {
+        removeIf(predicateFn, removedFn, [](const H&, std::size_t) {});
+    }
+
+    // Removes all the items for which the predicate is true, keeping the order of the others, and reports the moved items.
+    template <typename H>
+    template <typename Predicate, typename Callback, typename MovedCallback>
+    void ItemBucket<H>::removeIf(Predicate predicateFn, Callback removedFn, MovedCallback movedFn) {
+        // Compact the arrays in place, in a single pass
+        std::size_t kept = 0;
+        for(std::size_t i = 0; i < handles.size(); i++) {
+            if(predicateFn(getBound(i))) {
+                removedFn(handles[i]);
+            } else {
+                minX[kept] = minX[i];
+                minY[kept] = minY[i];
+                maxX[kept] = maxX[i];
+                maxY[kept] = maxY[i];
+                handles[kept] = handles[i];
+                if(kept != i) {
+                    movedFn(handles[kept], kept);
+                }
+                kept++;
+            }
+        }
+
+        truncate(kept);
+    }
+
+    // Removes the items from the given index on, keeping the first ones.
+    template <typename H>
+    void ItemBucket<H>::truncate(std::size_t count) {
+        minX.resize(count);
+        minY.resize(count);
+        maxX.resize(count);
+        maxY.resize(count);
+        handles.resize(count);
+    }
+
+    // Returns the number of items in the bucket.
+    template <typename H>
+    std::size_t ItemBucket<H>::size() const {
+        return handles.size();
+    }
+
+    // Decides whether the bucket has no items.
+    template <typename H>
+    bool ItemBucket<H>::empty() const {
+        return handles.empty();
+    }
+
+    // Removes all the items from the bucket.
+    template <typename H>
+    void ItemBucket<H>::clear() {
+        minX.clear();
+        minY.clear();
+        maxX.clear();
+        maxY.clear();
+        handles.clear();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,417 @@
+#ifndef LINEAR_QUADTREE_H
+#define LINEAR_QUADTREE_H
+
+#include "bound.hpp"        /// qt::Bound
+#include "util.hpp"         /// qt::uint32_t, qt::uint8_t
+#include "slotmap.hpp"      /// qt::SlotMap
+#include "item_bucket.hpp"  /// qt::ItemBucket
+
+#include <vector>           /// std::vector
+#include <array>            /// std::array
+#include <utility>          /// std::pair
+#include <type_traits>      /// std::is_convertible
+
+namespace qt {
+    /**
+     * @brief A pointerless variant of the QuadTree, with the same insertion/query/removal operations.
+     * @tparam T The type of elements in the LinearQuadTree, it has to be convertible to qt::Bound type.
+     * @note The nodes are identified by their locational (Morton) codes: the root has the code 1, and the
+     *      children of the node with code c have the codes 4c + 0..3 (in NW, NE, SW, SE order). The nodes are
+     *      stored in an open addressing hash table keyed by their codes, and the bounds of the nodes are derived
+     *      from the codes instead of being stored. The items of all the nodes on the same level share one array,
+     *      sorted by the codes of the nodes, so a node only holds the range of its items in it, and every
+     *      subtree is a contiguous range on each level below it.
+     * @see QuadTree
+     */
+    template <typename T>
+    class LinearQuadTree {
+        /**
+         * Make sure that T is convertible to qt::Bound; if not,
+         * the compiler gives the corresponding error message.
+         */
+        static_assert(std::is_convertible<T, qt::Bound>::value, "Type T must be convertible to Bound.");
+
+        public:
+            /**
+             * @brief The type of the handles stored in the nodes, and also the type of the elements of a query result.
+             * @note It is the same type as QuadTree<T>::Handle.
+             */
+            typedef typename SlotMap<T>::Handle Handle;
+
+            /**
+             * @brief Reusable working memory of the removals (the traversal stack), so that once
+             *      it has grown large enough, repeated removals don't allocate.
+             * @note It can be passed to any number of calls, but only to one call at a time.
+             */
+            struct QueryScratch;
+
+            /**
+             * @brief Constructs an empty LinearQuadTree in the given bound.
+             * @param[in] bound The bound that contains all the future elements of the LinearQuadTree.
+             */
+            LinearQuadTree(const Bound &bound);
+
+            /**
+             * @brief Inserts an element into the LinearQuadTree.
+             * @param[in] itemWithBound An element with type T, which needs to be inserted into the LinearQuadTree.
+             * @return The Handle of the inserted element.
+             */
+            Handle insert(const T &itemWithBound);
+
+            /**
+             * @brief Inserts an element into the LinearQuadTree, by moving it.
+             * @param[in] itemWithBound An element with type T, which needs to be inserted into the LinearQuadTree.
+             * @return The Handle of the inserted element.
+             */
+            Handle insert(T &&itemWithBound);
+
+            /**
+             * @brief Inserts an element into the LinearQuadTree, constructed in place from the given arguments.
+             * @param[in] args The arguments forwarded to the constructor of T.
+             * @return The Handle of the inserted element.
+             * @note The element is appended to the array of its level, it gets into its sorted place at the next pack(),
+             *      unless it already belongs there.
+             */
+            template <typename... Args>
+            Handle emplace(Args&&... args);
+
+            /**
+             * @brief Searches the LinearQuadTree for elements that overlap with the given bound.
+             * @param[in] bound The search bound that all the found elements should overlap with.
+             * @return A std::vector of Handles, which identify the found elements.
+             */
+            std::vector<Handle> queryOverlap(const Bound &bound) const;
+
+            /**
+             * @brief Searches the LinearQuadTree for elements that overlap with the given bound, into a caller-owned container.
+             * @param[in] bound The search bound that all the found elements should overlap with.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             */
+            void queryOverlap(const Bound &bound, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief Searches the LinearQuadTree for elements that are fully contained within the given bound.
+             * @param[in] bound The search bound that should contain all the found elements.
+             * @return A std::vector of Handles, which identify the found elements.
+             */
+            std::vector<Handle> queryContain(const Bound &bound) const;
+
+            /**
+             * @brief Searches the LinearQuadTree for elements that are fully contained within the given bound, into a caller-owned container.
+             * @param[in] bound The search bound that should contain all the found elements.
+             * @param[out] foundItems The Handles of the found elements are appended to it, its existing elements are kept.
+             */
+            void queryContain(const Bound &bound, std::vector<Handle> &foundItems) const;
+
+            /**
+             * @brief Passes the elements that overlap with the given bound to the callback, one by one.
+             * @param[in] bound The search bound that all the visited elements should overlap with.
+             * @param[in] callback Called with the Handle of each found element. If it returns a value convertible
+             *      to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note Nothing is allocated on the heap, the traversal uses a fixed size stack.
+             */
+            template <typename Callback>
+            bool forEachOverlap(const Bound &bound, Callback callback) const;
+
+            /**
+             * @brief Passes the elements that are fully contained within the given bound to the callback, one by one.
+             * @param[in] bound The search bound that should contain all the visited elements.
+             * @param[in] callback Called with the Handle of each found element. If it returns a value convertible
+             *      to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note Nothing is allocated on the heap, the traversal uses a fixed size stack.
+             */
+            template <typename Callback>
+            bool forEachContain(const Bound &bound, Callback callback) const;
+
+            /**
+             * @brief Passes the elements that overlap with the given bound to the callback, in contiguous ranges of Handles.
+             * @param[in] bound The search bound that all the visited elements should overlap with.
+             * @param[in] callback Called with two const Handle pointers [first, last) for each found range. If it returns
+             *      a value convertible to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note A subtree that is fully covered by the bound is passed as a single range on each of its levels,
+             *      without being walked. The ranges are valid until the LinearQuadTree is modified.
+             *      The own elements of the root are always tested one by one, since the elements outside of the tree bound are kept there.
+             * @see LinearQuadTree<T>::pack
+             */
+            template <typename Callback>
+            bool forEachOverlapRange(const Bound &bound, Callback callback) const;
+
+            /**
+             * @brief Passes the elements that are fully contained within the given bound to the callback, in contiguous ranges of Handles.
+             * @param[in] bound The search bound that should contain all the visited elements.
+             * @param[in] callback Called with two const Handle pointers [first, last) for each found range. If it returns
+             *      a value convertible to bool, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             * @note A subtree that is fully covered by the bound is passed as a single range on each of its levels.
+             * @see LinearQuadTree<T>::pack
+             */
+            template <typename Callback>
+            bool forEachContainRange(const Bound &bound, Callback callback) const;
+
+            /**
+             * @brief Removes all elements from the LinearQuadTree that overlap with the given bound.
+             * @param[in] bound The bound that all the removed elements should overlap with.
+             */
+            void removeOverlap(const Bound &bound);
+
+            /**
+             * @brief Removes all elements from the LinearQuadTree that overlap with the given bound, using the given working memory.
+             * @param[in] bound The bound that all the removed elements should overlap with.
+             * @param[in,out] scratch The reusable traversal stack.
+             */
+            void removeOverlap(const Bound &bound, QueryScratch &scratch);
+
+            /**
+             * @brief Removes all elements from the LinearQuadTree that are contained within the given bound.
+             * @param[in] bound The bound that contains all the elements that should be removed.
+             */
+            void removeContain(const Bound &bound);
+
+            /**
+             * @brief Removes all elements from the LinearQuadTree that are contained within the given bound, using the given working memory.
+             * @param[in] bound The bound that contains all the elements that should be removed.
+             * @param[in,out] scratch The reusable traversal stack.
+             */
+            void removeContain(const Bound &bound, QueryScratch &scratch);
+
+            /**
+             * @brief Sorts the recently inserted elements into the arrays of their levels, so that the queries
+             *      find them through their nodes, instead of testing them one by one.
+             * @note It takes linear time on the levels that have unsorted elements, and nothing otherwise.
+             */
+            void pack();
+
+            /**
+             * @brief Decides whether all the elements are in their sorted place, i.e. there was no insertion since the last pack().
+             */
+            bool isPacked() const;
+
+            /**
+             * @brief Returns all the boundaries that make up the LinearQuadTree.
+             * @return A std::vector of qt::Bounds, the bounds of all the existing nodes.
+             */
+            std::vector<Bound> getBounds() const;
+
+            /**
+             * @brief Removes all the elements and nodes from the LinearQuadTree.
+             */
+            void clear();
+
+            /**
+             * @brief Accesses the element identified by the given Handle.
+             * @param[in] handle A Handle whose element hasn't been removed yet.
+             */
+            T& operator[](const Handle &handle);
+            const T& operator[](const Handle &handle) const;
+
+            /**
+             * @brief Decides whether the given Handle still identifies an element of the LinearQuadTree.
+             */
+            bool contains(const Handle &handle) const;
+
+            /**
+             * @brief Returns the number of elements stored in the LinearQuadTree.
+             */
+            std::size_t size() const;
+
+            /**
+             * @brief Derives the bound of a node from its locational code.
+             * @param[in] code The locational code of the node.
+             * @return The bound of the node, the same as the bound of the corresponding QuadTreeNode.
+             */
+            Bound getNodeBound(uint32_t code) const;
+
+        protected:
+            /**
+             * @brief The maximal depth (plus 1) that a node can reach, the same as in the QuadTree.
+             * @note The codes have 2 * depth + 1 significant bits, so it can be at most 16.
+             */
+            static const int MAXDEPTH = 6;
+
+            /**
+             * @brief The size of the fixed traversal stack of the queries: a node is replaced by at most
+             *      four children on the next level, so at most three nodes wait on each level, and one more at the bottom.
+             */
+            static const int MAXSTACKSIZE = 3 * (MAXDEPTH - 1) + 1;
+
+            /**
+             * @brief Marks the empty entries of the hash table.
+             */
+            static const uint32_t NOCODE = 0;
+
+            /**
+             * @brief An entry of the node hash table.
+             */
+            struct Node {
+                /**
+                 * @brief The locational code of the node, or NOCODE if the entry is empty.
+                 */
+                uint32_t code;
+
+                /**
+                 * @brief The range [begin, begin + count) of the items of the node in the sorted part of its level.
+                 */
+                uint32_t begin;
+                uint32_t count;
+
+                /**
+                 * @brief The i-th bit is set if the i-th child of the node exists.
+                 */
+                uint8_t childMask;
+            };
+
+            /**
+             * @brief The items of all the nodes on one level of the tree.
+             */
+            struct Level {
+                /**
+                 * @brief The handles and bounds of the items.
+                 */
+                ItemBucket<Handle> items;
+
+                /**
+                 * @brief The code of the node of each item, the i-th entry belongs to the i-th item.
+                 */
+                std::vector<uint32_t> codes;
+
+                /**
+                 * @brief The first packedCount items are sorted by their codes, and are found through the ranges of
+                 *      their nodes. The items after them were inserted since the last pack(), in no particular order.
+                 */
+                std::size_t packedCount;
+            };
+
+            /**
+             * @brief A node that is visited during a traversal, together with its derived bound.
+             */
+            struct NodeVisit {
+                uint32_t code;
+                Bound bound;
+            };
+
+            /**
+             * @brief Finds the entry of a node in the hash table.
+             * @param[in] code The locational code of the node.
+             * @return The index of the entry of the node, or of the empty entry where it should be inserted.
+             */
+            std::size_t findSlot(uint32_t code) const;
+
+            /**
+             * @brief Returns the node with the given code, creating it if it doesn't exist.
+             * @note It may grow the hash table, so previously returned references become invalid.
+             */
+            Node& findOrCreateNode(uint32_t code);
+
+            /**
+             * @brief Returns the existing node with the given code.
+             */
+            const Node& getNode(uint32_t code) const;
+            Node& getNode(uint32_t code);
+
+            /**
+             * @brief Doubles the capacity of the hash table, and reinserts all the nodes.
+             */
+            void grow();
+
+            /**
+             * @brief Decides whether a node at the given depth, with the given bound, can't have children.
+             */
+            static bool isLeaf(const Bound &bound, int depth);
+
+            /**
+             * @brief Returns the depth of a node, based on its code.
+             */
+            static int getDepth(uint32_t code);
+
+            /**
+             * @brief Returns the range of the items of a subtree in the sorted part of a level.
+             * @param[in] code The locational code of the root of the subtree.
+             * @param[in] level The level of interest, at least the depth of the root of the subtree.
+             * @return The index range [first, second) in the sorted part of the level.
+             */
+            std::pair<std::size_t, std::size_t> getSubtreeRange(uint32_t code, int level) const;
+
+            /**
+             * @brief Visits the elements that are in relation with the given bound, based on the binary predicate.
+             * @param[in] bound The search bound.
+             * @param[in] predicateFn Binary predicate, taking two Bound arguments. It has to accept every element
+             *      of a node that is contained within the search bound (as the overlap and contain tests do).
+             * @param[in] rangeCallback Called with the ranges of the found Handles, returning false stops the search.
+             * @return false if the search was stopped by the callback, true otherwise.
+             */
+            template <typename Predicate, typename RangeCallback>
+            bool visit(const Bound &bound, Predicate predicateFn, RangeCallback &rangeCallback) const;
+
+            /**
+             * @brief Removes the elements that are in relation with the given bound, based on the binary predicate.
+             * @param[in] bound The bound of interest.
+             * @param[in] predicateFn Binary predicate, taking two Bound arguments, with the same requirement as in visit.
+             * @param[in,out] scratch The traversal stack, its previous content is discarded.
+             */
+            template <typename Predicate>
+            void remove(const Bound &bound, Predicate predicateFn, QueryScratch &scratch);
+
+            /**
+             * @brief Drops the removed items from the array of a level, and updates the ranges of its nodes.
+             * @param[in] depth The level, whose items may have been erased from the SlotMap.
+             */
+            void compact(int depth);
+
+            /**
+             * @brief Calls the visitor callback with the given arguments, and tells whether the traversal should continue.
+             */
+            template <typename Callback, typename... Args>
+            static bool invokeCallback(Callback &callback, const Args&... args);
+
+            /**
+             * @brief Calls the visitor callback with each element of a range, and tells whether the traversal should continue.
+             */
+            template <typename Callback>
+            static bool invokeForEach(Callback &callback, const Handle *first, const Handle *last);
+
+            /**
+             * @brief The container in which the inserted items are stored.
+             */
+            SlotMap<T> items;
+
+            /**
+             * @brief The bound of the root node.
+             */
+            Bound bound;
+
+            /**
+             * @brief The open addressing (linear probing) hash table of the nodes, its size is a power of 2.
+             */
+            std::vector<Node> nodes;
+
+            /**
+             * @brief The number of nodes in the hash table.
+             */
+            std::size_t nodeCount;
+
+            /**
+             * @brief The shared item arrays of the levels, indexed by the depth of the nodes.
+             */
+            std::array<Level, MAXDEPTH> levels;
+    };
+
+    /**
+     * @brief Inner struct of LinearQuadTree, the reusable working memory of the removals.
+     * @tparam T The type of elements in the LinearQuadTree.
+     */
+    template <typename T>
+    struct LinearQuadTree<T>::QueryScratch {
+        /**
+         * @brief The nodes that are still to be inspected, together with their bounds.
+         */
+        std::vector<NodeVisit> nodeStack;
+    };
+}
+
+// The template definitions, so that the class can be used header-only, without explicit instantiation
+#include "linear_quadtree.tpp"
+
+#endif
\ No newline at end of file
@@ -9,7 +9,11 @@ namespace qt {
      */
     typedef std::int8_t int8_t;
     typedef std::uint8_t uint8_t;
+    typedef std::uint16_t uint16_t;
     typedef std::int32_t int32_t;
+    typedef std::uint32_t uint32_t;
+    typedef std::int64_t int64_t;
+    typedef std::uint64_t uint64_t;
 
     /** 
      * @brief Generic type, representing a 2D vector/point.
@@ -26,21 +30,21 @@ namespace qt {
             /**
              * @brief Constructs a 2D vector/point with given coordinates.
              */
-            Vec2D(T x = 0, T y = 0);
+            constexpr Vec2D(T x = 0, T y = 0) noexcept;
 
             /**
              * @brief Calculates the vectorial sum of two vectors.
              * @param other The RHS operand.
              * @return A new Vec2D<T>, the sum of the two vectors.
              */
-            Vec2D<T> operator+(const Vec2D<T> &other) const;
+            constexpr Vec2D<T> operator+(const Vec2D<T> &other) const noexcept;
 
             /**
              * @brief Calculates the vectorial difference of two vectors.
              * @param other The RHS operand.
              * @return A new Vec2D<T>, the difference of the two vectors.
              */
-            Vec2D<T> operator-(const Vec2D<T> &other) const; 
+            constexpr Vec2D<T> operator-(const Vec2D<T> &other) const noexcept;
         
             /**
              * @todo Implement and overload all operations.
@@ -48,9 +52,34 @@ namespace qt {
     };
 
     /** 
-     * @brief 32 bit signed integral type, has to be declared in the implementation
+     * @brief 32 bit signed integral type.
      */
     typedef Vec2D<int32_t> Vec2D_i32;
+
+    /** 
+     * @brief Double precision floating point type, for directions and non-integral points.
+     */
+    typedef Vec2D<double> Vec2D_f64;
+
+    /*------------------------------------------------
+            Vec2D template class implementation
+    --------------------------------------------------*/
+
+    // Constructs a 2D vector/point with given coordinates.
+    template <typename T>
+    constexpr Vec2D<T>::Vec2D(T x, T y) noexcept : x(x), y(y) {}
+
+    // Calculates the vectorial sum of two vectors.
+    template <typename T>
+    constexpr Vec2D<T> Vec2D<T>::operator+(const Vec2D<T> &other) const noexcept {
+        return Vec2D(x + other.x, y + other.y);
+    }
+
+    // Returns the vectorial difference of two vectors.
+    template <typename T>
+    constexpr Vec2D<T> Vec2D<T>::operator-(const Vec2D<T> &other) const noexcept {
+        return Vec2D(x - other.x, y - other.y);
+    }
 }
 
 #endif
\ No newline at end of file